@@ -0,0 +1,326 @@
+// Request hot path microbenchmark
+// Covers the conversion code every request runs: BSON <-> Product in the
+// Mongo adapter, Product -> ProductResponse in the service, response and
+// request JSON in the DTOs, and route / query string parsing in the HTTP
+// adapter, then whole GET requests from the in-memory store (with and
+// without the product cache) through ProductHandler. Each benchmark
+// reports allocs_per_op next to its timings.
+//
+// Save a regression baseline with
+//   bench_hotpaths --benchmark_out=baseline.json --benchmark_out_format=json
+// and compare a later run against it with Google Benchmark's
+// tools/compare.py benchmarks baseline.json current.json
+
+#include "adapters/ProductHandler.h"
+#include "adapters/QueryParams.h"
+#include "adapters/Router.h"
+#include "domain/CachingProductRepository.h"
+#include "domain/InMemoryProductRepository.h"
+#include "domain/ProductRepositoryMongo.h"
+#include "dto/ProductResponse.h"
+#include "service/ProductService.h"
+#include "utils/JsonWriter.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace http = boost::beast::http;
+
+namespace {
+
+std::atomic<std::uint64_t> gAllocations{0};
+
+void* countedAlloc(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size > 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+// Every heap allocation in the process goes through these
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Counts allocations made while the benchmark loop runs and reports
+// them per iteration
+class AllocationCounter {
+public:
+    explicit AllocationCounter(benchmark::State& state)
+        : state_(state), start_(gAllocations.load(std::memory_order_relaxed)) {}
+
+    ~AllocationCounter() {
+        auto allocations = static_cast<double>(gAllocations.load(std::memory_order_relaxed) - start_);
+        state_.counters["allocs_per_op"] =
+            benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& state_;
+    std::uint64_t start_;
+};
+
+domain::Product makeProduct(std::size_t i) {
+    char id[25];
+    std::snprintf(id, sizeof(id), "65a1f0c2e4b0%012zx", i);
+    return domain::Product(id, "Wireless Mouse " + std::to_string(i),
+                           "Ergonomic wireless mouse with \"silent\" clicks\nand USB receiver",
+                           29.99 + static_cast<double>(i % 100), static_cast<int>(i % 200),
+                           "Electronics");
+}
+
+domain::ProductPtr makeSnapshot(std::size_t i) {
+    return std::make_shared<const domain::Product>(makeProduct(i));
+}
+
+std::vector<bsoncxx::document::value> makeDocuments(std::size_t count) {
+    std::vector<bsoncxx::document::value> docs;
+    docs.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        docs.push_back(domain::ProductRepositoryMongo::productToDocument(makeProduct(i)));
+    }
+    return docs;
+}
+
+// --- Mongo adapter: BSON mapping ---
+
+void BM_DocumentToProduct(benchmark::State& state) {
+    auto doc = domain::ProductRepositoryMongo::productToDocument(makeProduct(1));
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        auto product = domain::ProductRepositoryMongo::documentToProduct(doc.view());
+        benchmark::DoNotOptimize(product);
+    }
+}
+BENCHMARK(BM_DocumentToProduct);
+
+void BM_ProductToDocument(benchmark::State& state) {
+    auto product = makeProduct(1);
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        auto doc = domain::ProductRepositoryMongo::productToDocument(product);
+        benchmark::DoNotOptimize(doc);
+    }
+}
+BENCHMARK(BM_ProductToDocument);
+
+void BM_ProductToUpdate(benchmark::State& state) {
+    auto product = makeProduct(1);
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        auto doc = domain::ProductRepositoryMongo::productToUpdate(product);
+        benchmark::DoNotOptimize(doc);
+    }
+}
+BENCHMARK(BM_ProductToUpdate);
+
+// --- Service: domain -> DTO ---
+
+void BM_ProductToDto(benchmark::State& state) {
+    auto product = makeSnapshot(1);
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        auto dto = service::ProductService::productToDto(product);
+        benchmark::DoNotOptimize(dto);
+    }
+}
+BENCHMARK(BM_ProductToDto);
+
+// --- DTOs: response and request JSON ---
+
+void BM_ProductResponse_Dump(benchmark::State& state) {
+    auto dto = service::ProductService::productToDto(makeSnapshot(1));
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        std::string body = dto.toJson().dump();
+        benchmark::DoNotOptimize(body);
+    }
+}
+BENCHMARK(BM_ProductResponse_Dump);
+
+void BM_ProductResponse_JsonWriter(benchmark::State& state) {
+    auto dto = service::ProductService::productToDto(makeSnapshot(1));
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        std::string body;
+        utils::JsonWriter writer(body);
+        dto.write(writer);
+        benchmark::DoNotOptimize(body);
+    }
+}
+BENCHMARK(BM_ProductResponse_JsonWriter);
+
+// Parse plus fromJson, as POST /products does with the request body
+void BM_CreateProductRequest_FromJson(benchmark::State& state) {
+    const std::string body = R"({"name":"Wireless Mouse","description":"Ergonomic wireless mouse )"
+                             R"(with silent clicks","price":29.99,"stock":150,"category":"Electronics"})";
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        auto request = dto::CreateProductRequest::fromJson(nlohmann::json::parse(body));
+        benchmark::DoNotOptimize(request);
+    }
+}
+BENCHMARK(BM_CreateProductRequest_FromJson);
+
+// --- HTTP adapter: path and query parsing ---
+
+adapters::Router makeRouter() {
+    // Same table as ProductHandler; handlers are never called
+    adapters::Router router;
+    adapters::Router::Handler handler = [](const adapters::Router::Request&,
+                                           const adapters::RouteParams&) {
+        return adapters::Router::Response{};
+    };
+    router.add(http::verb::get, "/products", handler);
+    router.add(http::verb::get, "/products/{id:oid}", handler);
+    router.add(http::verb::post, "/products", handler);
+    router.add(http::verb::post, "/products/_bulk", handler);
+    router.add(http::verb::put, "/products/{id:oid}", handler);
+    router.add(http::verb::patch, "/products/{id:oid}", handler);
+    router.add(http::verb::post, "/products/{id:oid}/reserve", handler);
+    router.add(http::verb::post, "/products/{id:oid}/release", handler);
+    router.add(http::verb::post, "/products/_reserve", handler);
+    router.add(http::verb::post, "/products/_release", handler);
+    router.add(http::verb::delete_, "/products/{id:oid}", handler);
+    router.add(http::verb::get, "/health", handler);
+    router.add(http::verb::get, "/metrics", handler);
+    return router;
+}
+
+// Replaces the former extractIdFromPath: match and capture the id
+void BM_Router_MatchProductId(benchmark::State& state) {
+    auto router = makeRouter();
+    const std::string path = "/products/65a1f0c2e4b0000000000001";
+    adapters::RouteParams params;
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        params.clear();
+        const auto* route = router.match(http::verb::put, path, params);
+        auto id = params.get("id");
+        benchmark::DoNotOptimize(route);
+        benchmark::DoNotOptimize(id);
+    }
+}
+BENCHMARK(BM_Router_MatchProductId);
+
+// Replaces the former extractQueryParam: parse a list query string
+void BM_QueryParams_List(benchmark::State& state) {
+    const std::string target =
+        "/products?category=Home%20%26%20Garden&limit=50&after=65a1f0c2e4b0000000000001";
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        adapters::QueryParams query(target);
+        auto category = query.get("category");
+        auto limit = query.get("limit");
+        auto after = query.get("after");
+        benchmark::DoNotOptimize(category);
+        benchmark::DoNotOptimize(limit);
+        benchmark::DoNotOptimize(after);
+    }
+}
+BENCHMARK(BM_QueryParams_List);
+
+// --- Whole list path by catalog size: BSON -> Product -> DTO -> JSON ---
+
+void BM_CatalogPage(benchmark::State& state) {
+    auto docs = makeDocuments(static_cast<std::size_t>(state.range(0)));
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        dto::ProductPageResponse page;
+        page.items.reserve(docs.size());
+        for (const auto& doc : docs) {
+            page.items.push_back(service::ProductService::productToDto(
+                domain::ProductRepositoryMongo::documentToProduct(doc.view())));
+        }
+
+        std::string body;
+        body.reserve(page.items.size() * 192 + 2);
+        utils::JsonWriter writer(body);
+        writer.beginArray(page.items.size());
+        for (const auto& product : page.items) {
+            product.write(writer);
+        }
+        writer.endArray();
+        benchmark::DoNotOptimize(body);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CatalogPage)->RangeMultiplier(10)->Range(10, 10000);
+
+// --- Whole request: repository -> service -> handler ---
+
+// 1000 products in the in-memory store, read directly and through the
+// product cache (the path of a cache hit in front of Mongo)
+struct Catalog {
+    std::vector<std::string> ids;
+    std::unique_ptr<adapters::ProductHandler> direct;
+    std::unique_ptr<adapters::ProductHandler> cached;
+};
+
+Catalog& catalog() {
+    static Catalog instance = [] {
+        Catalog c;
+        auto store = std::make_shared<domain::InMemoryProductRepository>();
+        for (std::size_t i = 0; i < 1000; ++i) {
+            c.ids.push_back(store->create(makeProduct(i)).first);
+        }
+        auto cache = std::make_shared<domain::CachingProductRepository>(store);
+        c.direct = std::make_unique<adapters::ProductHandler>(
+            std::make_shared<service::ProductService>(store));
+        c.cached = std::make_unique<adapters::ProductHandler>(
+            std::make_shared<service::ProductService>(cache));
+        return c;
+    }();
+    return instance;
+}
+
+// Arg 1 serves through the product cache
+void runRequest(benchmark::State& state, const std::string& target) {
+    auto& handler = state.range(0) ? *catalog().cached : *catalog().direct;
+    http::request<http::string_body> req{http::verb::get, target, 11};
+    handler.handleRequest(req);
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        auto res = handler.handleRequest(req);
+        benchmark::DoNotOptimize(res);
+    }
+}
+
+void BM_Request_GetProduct(benchmark::State& state) {
+    runRequest(state, "/products/" + catalog().ids[500]);
+}
+BENCHMARK(BM_Request_GetProduct)->ArgName("cached")->Arg(0)->Arg(1);
+
+void BM_Request_ListPage(benchmark::State& state) {
+    runRequest(state, "/products?limit=100");
+    state.SetItemsProcessed(state.iterations() * 100);
+}
+BENCHMARK(BM_Request_ListPage)->ArgName("cached")->Arg(0)->Arg(1);
+
+void BM_Request_GetByIds(benchmark::State& state) {
+    std::string target = "/products?ids=";
+    for (std::size_t i = 0; i < 10; ++i) {
+        target += (i > 0 ? "," : "") + catalog().ids[i * 97];
+    }
+    runRequest(state, target);
+}
+BENCHMARK(BM_Request_GetByIds)->ArgName("cached")->Arg(0)->Arg(1);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,393 @@
+// HTTP load benchmark
+// Starts HttpServer in-process on top of InMemoryProductRepository and
+// drives it with keep-alive Beast clients, reporting throughput and
+// latency percentiles per route. No MongoDB is needed.
+//
+//   bench_http [--connections=64] [--duration=10] [--warmup=2]
+//              [--server-threads=N] [--client-threads=N]
+//              [--mix=list:10,get:70,create:10,update:10]
+//              [--products=10000] [--categories=20] [--port=18080]
+//              [--model=shared|per-core] [--cache]
+
+#include "adapters/HttpServer.h"
+#include "adapters/ProductHandler.h"
+#include "domain/CachingProductRepository.h"
+#include "domain/InMemoryProductRepository.h"
+#include "service/ProductService.h"
+#include "utils/Logger.h"
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+enum Operation { List, Get, Create, Update, kOperationCount };
+constexpr const char* kOperationNames[] = {"list", "get", "create", "update"};
+
+struct BenchOptions {
+    std::size_t connections{64};
+    int duration{10};
+    int warmup{2};
+    std::size_t serverThreads{std::max(1u, std::thread::hardware_concurrency() / 2)};
+    std::size_t clientThreads{std::max(1u, std::thread::hardware_concurrency() / 2)};
+    std::array<unsigned, kOperationCount> mix{10, 70, 10, 10};
+    std::size_t products{10000};
+    std::size_t categories{20};
+    unsigned short port{18080};
+    bool perCore{false};
+    bool cache{false};
+};
+
+// Latencies and counts gathered by one connection, merged at the end
+struct ConnectionStats {
+    std::array<std::vector<std::uint32_t>, kOperationCount> latencyMicros;
+    std::uint64_t errors{0};
+};
+
+class ClientConnection : public std::enable_shared_from_this<ClientConnection> {
+public:
+    ClientConnection(net::io_context& ioc, tcp::endpoint endpoint, const BenchOptions& options,
+                     const std::vector<std::string>& ids, const std::atomic<int>& phase,
+                     ConnectionStats& stats, unsigned seed)
+        : stream_(ioc), endpoint_(endpoint), options_(options), ids_(ids), phase_(phase),
+          stats_(stats), random_(seed),
+          pick_(options.mix.begin(), options.mix.end()) {}
+
+    void start() {
+        stream_.async_connect(endpoint_,
+            [self = shared_from_this()](beast::error_code ec) {
+                if (ec) {
+                    ++self->stats_.errors;
+                    return;
+                }
+                self->sendNext();
+            });
+    }
+
+private:
+    beast::tcp_stream stream_;
+    tcp::endpoint endpoint_;
+    const BenchOptions& options_;
+    const std::vector<std::string>& ids_;
+    const std::atomic<int>& phase_;
+    ConnectionStats& stats_;
+    std::mt19937 random_;
+    std::discrete_distribution<int> pick_;
+    beast::flat_buffer buffer_;
+    http::request<http::string_body> req_;
+    http::response<http::string_body> res_;
+    Operation operation_{Get};
+    Clock::time_point sentAt_;
+
+    const std::string& randomId() {
+        return ids_[std::uniform_int_distribution<std::size_t>(0, ids_.size() - 1)(random_)];
+    }
+
+    std::string randomCategory() {
+        return "category-" + std::to_string(
+            std::uniform_int_distribution<std::size_t>(0, options_.categories - 1)(random_));
+    }
+
+    std::string productBody() {
+        auto n = std::uniform_int_distribution<int>(0, 999)(random_);
+        return "{\"name\":\"Bench product " + std::to_string(n) +
+               "\",\"description\":\"Generated by bench_http\",\"price\":" +
+               std::to_string(n) + ".99,\"stock\":" + std::to_string(n % 50) +
+               ",\"category\":\"" + randomCategory() + "\"}";
+    }
+
+    void buildRequest() {
+        operation_ = static_cast<Operation>(pick_(random_));
+        req_ = {};
+        req_.version(11);
+        req_.set(http::field::host, "localhost");
+        req_.keep_alive(true);
+
+        switch (operation_) {
+            case List:
+                req_.method(http::verb::get);
+                req_.target("/products?category=" + randomCategory() + "&limit=20");
+                break;
+            case Get:
+                req_.method(http::verb::get);
+                req_.target("/products/" + randomId());
+                break;
+            case Create:
+                req_.method(http::verb::post);
+                req_.target("/products");
+                req_.set(http::field::content_type, "application/json");
+                req_.body() = productBody();
+                break;
+            case Update:
+                req_.method(http::verb::put);
+                req_.target("/products/" + randomId());
+                req_.set(http::field::content_type, "application/json");
+                req_.body() = productBody();
+                break;
+            default:
+                break;
+        }
+        req_.prepare_payload();
+    }
+
+    void sendNext() {
+        if (phase_.load(std::memory_order_relaxed) == 2) {
+            beast::error_code ec;
+            stream_.socket().shutdown(tcp::socket::shutdown_both, ec);
+            return;
+        }
+
+        buildRequest();
+        sentAt_ = Clock::now();
+        http::async_write(stream_, req_,
+            [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                if (ec) {
+                    ++self->stats_.errors;
+                    return;
+                }
+                self->res_ = {};
+                http::async_read(self->stream_, self->buffer_, self->res_,
+                    [self](beast::error_code ec, std::size_t) { self->onResponse(ec); });
+            });
+    }
+
+    void onResponse(beast::error_code ec) {
+        if (ec) {
+            ++stats_.errors;
+            return;
+        }
+        if (phase_.load(std::memory_order_relaxed) == 1) {
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                Clock::now() - sentAt_).count();
+            if (res_.result_int() >= 400) {
+                ++stats_.errors;
+            } else {
+                stats_.latencyMicros[operation_].push_back(static_cast<std::uint32_t>(micros));
+            }
+        }
+        if (res_.need_eof()) {
+            // The server ended keep-alive; reconnect and carry on
+            beast::error_code ignored;
+            stream_.socket().close(ignored);
+            buffer_.clear();
+            start();
+            return;
+        }
+        sendNext();
+    }
+};
+
+std::uint32_t percentile(std::vector<std::uint32_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    auto index = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void printRow(const char* name, std::vector<std::uint32_t>& latencies, double seconds) {
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("%-8s %10zu %12.1f %8u %8u %8u %8u\n", name, latencies.size(),
+                static_cast<double>(latencies.size()) / seconds,
+                percentile(latencies, 0.50), percentile(latencies, 0.99),
+                percentile(latencies, 0.999), latencies.empty() ? 0 : latencies.back());
+}
+
+bool parseMix(const std::string& text, std::array<unsigned, kOperationCount>& mix) {
+    std::array<unsigned, kOperationCount> parsed{};
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        auto comma = text.find(',', pos);
+        auto item = text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        auto colon = item.find(':');
+        if (colon == std::string::npos) {
+            return false;
+        }
+        auto name = item.substr(0, colon);
+        auto it = std::find_if(std::begin(kOperationNames), std::end(kOperationNames),
+                               [&name](const char* op) { return name == op; });
+        if (it == std::end(kOperationNames)) {
+            return false;
+        }
+        parsed[it - std::begin(kOperationNames)] = static_cast<unsigned>(std::stoul(item.substr(colon + 1)));
+        pos = comma == std::string::npos ? text.size() : comma + 1;
+    }
+    mix = parsed;
+    return true;
+}
+
+bool parseArgs(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        auto key = arg.substr(0, eq);
+        auto value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+
+        if (key == "--connections") options.connections = std::stoul(value);
+        else if (key == "--duration") options.duration = std::stoi(value);
+        else if (key == "--warmup") options.warmup = std::stoi(value);
+        else if (key == "--server-threads") options.serverThreads = std::stoul(value);
+        else if (key == "--client-threads") options.clientThreads = std::stoul(value);
+        else if (key == "--products") options.products = std::stoul(value);
+        else if (key == "--categories") options.categories = std::stoul(value);
+        else if (key == "--port") options.port = static_cast<unsigned short>(std::stoul(value));
+        else if (key == "--model") options.perCore = value == "per-core";
+        else if (key == "--cache") options.cache = true;
+        else if (key == "--mix") {
+            if (!parseMix(value, options.mix)) {
+                std::cerr << "Invalid --mix, expected e.g. list:10,get:70,create:10,update:10\n";
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return options.connections > 0 && options.duration > 0 && options.products > 0 &&
+           options.categories > 0 && options.serverThreads > 0 && options.clientThreads > 0;
+}
+
+bool waitForServer(const tcp::endpoint& endpoint) {
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        net::io_context ioc;
+        tcp::socket socket(ioc);
+        beast::error_code ec;
+        socket.connect(endpoint, ec);
+        if (!ec) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        return 1;
+    }
+
+    utils::LoggerOptions loggerOptions;
+    loggerOptions.level = "warn";
+    loggerOptions.accessLogSampleRate = 0.0;
+    utils::Logger::init(loggerOptions);
+
+    // Seed the store before the clock starts
+    auto memory = std::make_shared<domain::InMemoryProductRepository>();
+    std::vector<std::string> ids;
+    ids.reserve(options.products);
+    for (std::size_t i = 0; i < options.products; ++i) {
+        domain::Product product("", "Seed product " + std::to_string(i), "Seeded by bench_http",
+                                9.99 + static_cast<double>(i % 100), static_cast<int>(i % 50),
+                                "category-" + std::to_string(i % options.categories));
+        ids.push_back(memory->create(product).first);
+    }
+
+    std::shared_ptr<domain::ProductRepository> repository = memory;
+    if (options.cache) {
+        repository = std::make_shared<domain::CachingProductRepository>(repository);
+    }
+    auto service = std::make_shared<service::ProductService>(repository);
+    auto handler = std::make_shared<adapters::RequestHandler>(
+        std::make_shared<adapters::ProductHandler>(service));
+
+    adapters::ServerOptions serverOptions;
+    serverOptions.threads = options.serverThreads;
+    serverOptions.model = options.perCore ? adapters::ExecutionModel::ThreadPerCore
+                                          : adapters::ExecutionModel::SharedIoContext;
+    serverOptions.maxRequestsPerConnection = std::numeric_limits<std::size_t>::max();
+    adapters::HttpServer server("127.0.0.1", options.port, handler, serverOptions);
+    std::thread serverThread([&server] { server.run(); });
+
+    tcp::endpoint endpoint{net::ip::make_address("127.0.0.1"), options.port};
+    if (!waitForServer(endpoint)) {
+        std::cerr << "Server did not start on port " << options.port << "\n";
+        server.stop();
+        serverThread.join();
+        return 1;
+    }
+
+    // 0 = warmup, 1 = measuring, 2 = draining
+    std::atomic<int> phase{0};
+    std::vector<ConnectionStats> stats(options.connections);
+    std::vector<std::unique_ptr<net::io_context>> contexts;
+    for (std::size_t i = 0; i < options.clientThreads; ++i) {
+        contexts.push_back(std::make_unique<net::io_context>(1));
+    }
+    for (std::size_t i = 0; i < options.connections; ++i) {
+        std::make_shared<ClientConnection>(*contexts[i % contexts.size()], endpoint, options, ids,
+                                           phase, stats[i], static_cast<unsigned>(i + 1))->start();
+    }
+
+    std::vector<std::thread> clientThreads;
+    for (auto& ioc : contexts) {
+        clientThreads.emplace_back([&ioc] { ioc->run(); });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(options.warmup));
+    phase = 1;
+    auto measureStart = Clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(options.duration));
+    phase = 2;
+    auto seconds = std::chrono::duration<double>(Clock::now() - measureStart).count();
+
+    for (auto& thread : clientThreads) {
+        thread.join();
+    }
+    server.stop();
+    serverThread.join();
+
+    std::array<std::vector<std::uint32_t>, kOperationCount> byOperation;
+    std::vector<std::uint32_t> all;
+    std::uint64_t errors = 0;
+    for (auto& connection : stats) {
+        for (std::size_t op = 0; op < kOperationCount; ++op) {
+            auto& latencies = connection.latencyMicros[op];
+            byOperation[op].insert(byOperation[op].end(), latencies.begin(), latencies.end());
+            all.insert(all.end(), latencies.begin(), latencies.end());
+        }
+        errors += connection.errors;
+    }
+
+    std::printf("bench_http: %zu connections, %zu server threads (%s), %zu client threads, "
+                "%d s measured after %d s warmup%s\n",
+                options.connections, options.serverThreads,
+                options.perCore ? "per-core" : "shared", options.clientThreads,
+                options.duration, options.warmup, options.cache ? ", cache on" : "");
+    std::printf("mix: list %u, get %u, create %u, update %u; %zu seeded products in %zu categories\n\n",
+                options.mix[List], options.mix[Get], options.mix[Create], options.mix[Update],
+                options.products, options.categories);
+    std::printf("%-8s %10s %12s %8s %8s %8s %8s\n",
+                "route", "requests", "rps", "p50 us", "p99 us", "p99.9 us", "max us");
+    for (std::size_t op = 0; op < kOperationCount; ++op) {
+        if (options.mix[op] > 0) {
+            printRow(kOperationNames[op], byOperation[op], seconds);
+        }
+    }
+    printRow("total", all, seconds);
+    std::printf("\nerrors: %llu\n", static_cast<unsigned long long>(errors));
+
+    utils::Logger::shutdown();
+    return errors > 0 && all.empty() ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+// Serialization microbenchmark
+// Compares the streaming writers (JSON, MessagePack, CBOR) against
+// building a nlohmann::json tree and calling dump(), for a single
+// product, a page of products and an error body, then decoding the same
+// page and a create request body in each format. Encoded sizes are
+// reported as the bytes counter.
+
+#include "dto/ProductResponse.h"
+#include "utils/Serialization.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<dto::ProductResponse> makeProducts(std::size_t count) {
+    std::vector<dto::ProductResponse> products;
+    products.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        products.push_back(dto::ProductResponse{std::make_shared<const domain::Product>(
+            "65a1f0c2e4b0" + std::to_string(100000000000 + i),
+            "Wireless Mouse " + std::to_string(i),
+            "Ergonomic wireless mouse with \"silent\" clicks\nand USB receiver",
+            29.99 + static_cast<double>(i % 100), static_cast<int>(i % 200), "Electronics")});
+    }
+    return products;
+}
+
+void BM_Product_NlohmannDump(benchmark::State& state) {
+    auto product = makeProducts(1).front();
+    for (auto _ : state) {
+        std::string body = product.toJson().dump();
+        benchmark::DoNotOptimize(body);
+    }
+}
+BENCHMARK(BM_Product_NlohmannDump);
+
+template <typename Writer>
+void BM_Product_Write(benchmark::State& state) {
+    auto product = makeProducts(1).front();
+    std::size_t bytes = 0;
+    for (auto _ : state) {
+        std::string body;
+        Writer writer(body);
+        product.write(writer);
+        bytes = body.size();
+        benchmark::DoNotOptimize(body);
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK_TEMPLATE(BM_Product_Write, utils::JsonWriter);
+BENCHMARK_TEMPLATE(BM_Product_Write, utils::MsgPackWriter);
+BENCHMARK_TEMPLATE(BM_Product_Write, utils::CborWriter);
+
+void BM_List_NlohmannDump(benchmark::State& state) {
+    auto products = makeProducts(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        nlohmann::json array = nlohmann::json::array();
+        for (const auto& product : products) {
+            array.push_back(product.toJson());
+        }
+        std::string body = array.dump();
+        benchmark::DoNotOptimize(body);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_List_NlohmannDump)->RangeMultiplier(10)->Range(10, 1000);
+
+template <typename Writer>
+void writeList(Writer& writer, const std::vector<dto::ProductResponse>& products) {
+    writer.beginArray(products.size());
+    for (const auto& product : products) {
+        product.write(writer);
+    }
+    writer.endArray();
+}
+
+template <typename Writer>
+void BM_List_Write(benchmark::State& state) {
+    auto products = makeProducts(static_cast<std::size_t>(state.range(0)));
+    std::size_t bytes = 0;
+    for (auto _ : state) {
+        std::string body;
+        body.reserve(products.size() * 192 + 2);
+        Writer writer(body);
+        writeList(writer, products);
+        bytes = body.size();
+        benchmark::DoNotOptimize(body);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK_TEMPLATE(BM_List_Write, utils::JsonWriter)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK_TEMPLATE(BM_List_Write, utils::MsgPackWriter)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK_TEMPLATE(BM_List_Write, utils::CborWriter)->RangeMultiplier(10)->Range(10, 1000);
+
+void BM_Error_NlohmannDump(benchmark::State& state) {
+    dto::ErrorResponse error{404, "Product not found"};
+    for (auto _ : state) {
+        std::string body = error.toJson().dump();
+        benchmark::DoNotOptimize(body);
+    }
+}
+BENCHMARK(BM_Error_NlohmannDump);
+
+void BM_Error_JsonWriter(benchmark::State& state) {
+    dto::ErrorResponse error{404, "Product not found"};
+    for (auto _ : state) {
+        std::string body;
+        utils::JsonWriter writer(body);
+        error.write(writer);
+        benchmark::DoNotOptimize(body);
+    }
+}
+BENCHMARK(BM_Error_JsonWriter);
+
+// Decoding a page of products: what a client using nlohmann pays per
+// response, and the parser request bodies go through
+void BM_List_Parse(benchmark::State& state, utils::MediaType type) {
+    auto products = makeProducts(static_cast<std::size_t>(state.range(0)));
+    std::string body;
+    utils::serialize(type, body, [&products](auto& writer) { writeList(writer, products); });
+    for (auto _ : state) {
+        auto document = utils::parseBody(type, body);
+        benchmark::DoNotOptimize(document);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes"] = static_cast<double>(body.size());
+}
+BENCHMARK_CAPTURE(BM_List_Parse, json, utils::MediaType::Json)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK_CAPTURE(BM_List_Parse, msgpack, utils::MediaType::MessagePack)
+    ->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK_CAPTURE(BM_List_Parse, cbor, utils::MediaType::Cbor)->RangeMultiplier(10)->Range(10, 1000);
+
+// Body of POST /products to request DTO, as the handler does it
+void BM_CreateRequest_Parse(benchmark::State& state, utils::MediaType type) {
+    auto request = nlohmann::json{{"name", "Wireless Mouse"},
+                                  {"description", "Ergonomic wireless mouse with silent clicks"},
+                                  {"price", 29.99}, {"stock", 150}, {"category", "Electronics"}};
+    auto body = utils::dumpBody(type, request);
+    for (auto _ : state) {
+        auto parsed = dto::CreateProductRequest::fromJson(utils::parseBody(type, body));
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.counters["bytes"] = static_cast<double>(body.size());
+}
+BENCHMARK_CAPTURE(BM_CreateRequest_Parse, json, utils::MediaType::Json);
+BENCHMARK_CAPTURE(BM_CreateRequest_Parse, msgpack, utils::MediaType::MessagePack);
+BENCHMARK_CAPTURE(BM_CreateRequest_Parse, cbor, utils::MediaType::Cbor);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "utils/Metrics.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace adapters {
+
+/**
+ * AdmissionOptions - Concurrency limits enforced by AdmissionController
+ */
+struct AdmissionOptions {
+    // Requests handled at once over all routes; 0 means unlimited
+    std::size_t maxInFlight{0};
+    // Requests handled at once on one route; 0 means unlimited
+    std::size_t maxInFlightPerRoute{0};
+    // Per-route overrides keyed by "METHOD pattern", e.g. "GET /products"
+    std::map<std::string, std::size_t> routeLimits;
+    // Sent as Retry-After on shed requests
+    std::chrono::seconds retryAfter{1};
+
+    // AIMD: the global limit is multiplied by backoff when repository
+    // latency exceeds latencyTarget (at most once per latencyTarget) and
+    // grows by about one per limit's worth of faster calls, between
+    // minLimit and maxInFlight
+    bool adaptive{false};
+    std::chrono::milliseconds latencyTarget{50};
+    double backoff{0.9};
+    std::size_t minLimit{4};
+};
+
+/**
+ * AdmissionStats - Snapshot of AdmissionController counters
+ */
+struct AdmissionStats {
+    std::size_t inFlight{0};
+    // Current global limit (0 when unlimited)
+    std::size_t limit{0};
+    std::uint64_t shed{0};
+};
+
+/**
+ * AdmissionController - Bounds the requests handled concurrently
+ * A request is admitted only while both the global and its route's
+ * in-flight counts are under their limits; otherwise it is shed at once
+ * with a 503, so a slow database costs rejected requests instead of a
+ * growing backlog that delays everyone. Admission is two atomic
+ * increments; no lock is taken.
+ */
+class AdmissionController {
+public:
+    explicit AdmissionController(AdmissionOptions options,
+                                 utils::MetricsRegistry& registry = utils::MetricsRegistry::global());
+
+    // Registers a route, in route table order. Exempt routes (health
+    // checks, metrics) are always admitted and not counted.
+    void addRoute(const std::string& method, const std::string& pattern, bool exempt = false);
+
+    // On success the caller must call release(route) when done
+    bool tryAcquire(std::size_t route);
+    void release(std::size_t route);
+
+    // Feeds the adaptive limit; a no-op unless options.adaptive
+    void observeLatency(std::chrono::steady_clock::duration latency);
+
+    std::chrono::seconds retryAfter() const { return options_.retryAfter; }
+
+    AdmissionStats stats() const;
+
+    // Parses "GET /products=16,POST /products/_bulk=2" into routeLimits;
+    // throws std::invalid_argument on a malformed entry
+    static std::map<std::string, std::size_t> parseRouteLimits(std::string_view spec);
+
+private:
+    struct RouteState {
+        std::size_t limit{0};
+        bool exempt{false};
+        std::atomic<std::size_t> inFlight{0};
+        // Shed by the global limit and by the route's own
+        utils::Counter* shedGlobal{nullptr};
+        utils::Counter* shedRoute{nullptr};
+    };
+
+    AdmissionOptions options_;
+    utils::MetricsRegistry& registry_;
+    std::vector<std::unique_ptr<RouteState>> routes_;
+
+    std::atomic<std::size_t> inFlight_{0};
+    // Fractional so additive increase can accumulate below one
+    std::atomic<double> limit_;
+    std::atomic<std::int64_t> lastDecreaseNanos_{0};
+    std::atomic<std::uint64_t> shed_{0};
+
+    utils::Gauge& limitGauge_;
+
+    std::size_t currentLimit() const;
+};
+
+} // namespace adapters
@@ -1,13 +1,54 @@
 #pragma once
 
+#include "utils/Compression.h"
 #include <boost/asio.hpp>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace adapters {
 
 class RequestHandler;
 
+/**
+ * Execution model used by HttpServer
+ * SharedIoContext: N threads run one io_context, each session on its own strand
+ * ThreadPerCore:   each thread owns an io_context and a SO_REUSEPORT listener
+ */
+enum class ExecutionModel {
+    SharedIoContext,
+    ThreadPerCore
+};
+
+/**
+ * ServerOptions - Tuning knobs for HttpServer
+ */
+struct ServerOptions {
+    ExecutionModel model{ExecutionModel::SharedIoContext};
+    std::size_t threads{1};
+    bool pinThreads{false};
+
+    // HTTP/1.1 keep-alive: a connection is closed after this many requests
+    // or when the next request does not start within the idle timeout
+    std::size_t maxRequestsPerConnection{1000};
+    std::chrono::seconds keepAliveTimeout{30};
+
+    // Deadlines for reading a request's header and body and for writing
+    // its response; a client that misses one is disconnected
+    std::chrono::seconds headerTimeout{10};
+    std::chrono::seconds bodyTimeout{30};
+    std::chrono::seconds writeTimeout{30};
+
+    // Open connections at which accepting pauses; 0 means unlimited
+    std::size_t maxConnections{0};
+    // Larger request bodies are answered with 413
+    std::size_t maxBodySize{1024 * 1024};
+
+    utils::CompressionOptions compression;
+};
+
 /**
  * HttpServer - Primary Adapter
  * Handles incoming HTTP requests using Boost.Beast
@@ -15,7 +56,8 @@ class RequestHandler;
 class HttpServer {
 public:
     HttpServer(const std::string& address, unsigned short port,
-               std::shared_ptr<RequestHandler> handler);
+               std::shared_ptr<RequestHandler> handler,
+               ServerOptions options = {});
     
     void run();
     void stop();
@@ -24,9 +66,11 @@ private:
     std::string address_;
     unsigned short port_;
     std::shared_ptr<RequestHandler> handler_;
-    boost::asio::io_context ioc_;
-    
-    void doAccept();
+    ServerOptions options_;
+    std::vector<std::unique_ptr<boost::asio::io_context>> contexts_;
+    std::vector<std::thread> threads_;
+
+    void runContext(std::size_t index);
 };
 
 } // namespace adapters
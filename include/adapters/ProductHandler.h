@@ -1,62 +1,194 @@
 #pragma once
 
+#include "adapters/AdmissionController.h"
+#include "adapters/ResponseCache.h"
+#include "adapters/Router.h"
 #include "service/ProductService.h"
+#include "utils/Metrics.h"
+#include "utils/Serialization.h"
+#include <boost/asio/thread_pool.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace beast = boost::beast;
 namespace http = beast::http;
 
 namespace adapters {
 
+/**
+ * ProductHandlerOptions - Limits applied by ProductHandler
+ */
+struct ProductHandlerOptions {
+    // Page size used when GET /products has no limit parameter
+    std::size_t defaultPageSize{100};
+    // Largest page a client may request; larger limits are clamped
+    std::size_t maxPageSize{1000};
+    // Largest batch accepted by POST /products/_bulk
+    std::size_t maxBulkOperations{1000};
+    // Concurrency limits; /health and /metrics are exempt
+    AdmissionOptions admission;
+};
+
 /**
  * ProductHandler - Primary Adapter
- * Handles HTTP requests for product operations
+ * Handles HTTP requests for product operations. Product bodies are read
+ * and written as JSON, MessagePack or CBOR, chosen by Content-Type and
+ * Accept; errors are always JSON.
  */
 class ProductHandler {
 public:
-    explicit ProductHandler(std::shared_ptr<service::ProductService> service);
+    // With a response cache, GET /products pages are served from it
+    explicit ProductHandler(std::shared_ptr<service::ProductService> service,
+                            ProductHandlerOptions options = {},
+                            std::shared_ptr<ResponseCache> responseCache = nullptr);
+    ~ProductHandler();
 
-    // Handle HTTP request
+    // Handle HTTP request: admit() then handleAdmitted()
     http::response<http::string_body> 
         handleRequest(const http::request<http::string_body>& req);
 
+    /**
+     * Admission - Route of a request and its admission slot
+     * Taken when the request arrives, before it may wait for a thread,
+     * and held until handleAdmitted() or shed() answers it. The route
+     * parameters point into the request target.
+     */
+    struct Admission {
+        const Router::Route* route{nullptr};
+        RouteParams params;
+        // False when admission control shed the request
+        bool admitted{false};
+        std::chrono::steady_clock::time_point start;
+    };
+
+    Admission admit(const http::request<http::string_body>& req);
+    // Runs an admitted request (a shed one gets its 503) and releases the slot
+    http::response<http::string_body> handleAdmitted(const http::request<http::string_body>& req,
+                                                     const Admission& admission);
+    // Answers with a 503 without running the request and releases the slot
+    http::response<http::string_body> shed(const Admission& admission);
+
+    // False for requests that never reach the repository (health checks,
+    // metrics, unmatched paths, shed requests), which are cheaper to answer
+    // in place
+    bool mayBlock(const Admission& admission) const;
+
+    // For feeding repository latency to the adaptive limit
+    AdmissionController& admission() { return admission_; }
+
+    http::response<http::string_body> createErrorResponse(int code,
+                                                          const std::string& message);
+    http::response<http::string_body> createOverloadedResponse();
+
 private:
+    using Request = http::request<http::string_body>;
+
     std::shared_ptr<service::ProductService> service_;
+    ProductHandlerOptions options_;
+    std::shared_ptr<ResponseCache> responseCache_;
+    Router router_;
+    AdmissionController admission_;
+    // Per route: whether its handler calls into the service
+    std::vector<bool> routeBlocks_;
+
+    // Latency histograms per route (plus one for unmatched requests) and status
+    struct RouteMetrics;
+    std::vector<std::unique_ptr<RouteMetrics>> routeMetrics_;
+    utils::Gauge& inFlight_;
+
+    void recordRequest(std::size_t routeIndex, unsigned status,
+                       std::chrono::steady_clock::duration elapsed);
 
     // Route handlers
     http::response<http::string_body> handleGetAllProducts(const http::request<http::string_body>& req);
-    http::response<http::string_body> handleGetProduct(const std::string& id);
+    http::response<http::string_body> handleGetProductsByIds(std::string_view idList,
+                                                             const http::request<http::string_body>& req);
+    http::response<http::string_body> handleGetProduct(const std::string& id,
+                                                       const http::request<http::string_body>& req);
     http::response<http::string_body> handleCreateProduct(const http::request<http::string_body>& req);
     http::response<http::string_body> handleUpdateProduct(const std::string& id, 
                                                           const http::request<http::string_body>& req);
-    http::response<http::string_body> handleDeleteProduct(const std::string& id);
+    http::response<http::string_body> handlePatchProduct(const std::string& id,
+                                                         const http::request<http::string_body>& req);
+    http::response<http::string_body> handleStockChange(const std::string& id,
+                                                        const http::request<http::string_body>& req,
+                                                        bool reserve);
+    http::response<http::string_body> handleStockBatch(const http::request<http::string_body>& req,
+                                                       bool reserve);
+    http::response<http::string_body> handleDeleteProduct(const std::string& id,
+                                                          const http::request<http::string_body>& req);
+    http::response<http::string_body> handleBulkWrite(const http::request<http::string_body>& req);
+    http::response<http::string_body> handleMetrics();
 
     // Helper methods
+    http::response<http::string_body> createCachedResponse(const CachedResponse& cached,
+                                                           const http::request<http::string_body>& req);
     http::response<http::string_body> createResponse(http::status status, 
                                                      const std::string& body);
     http::response<http::string_body> createJsonResponse(http::status status, 
-                                                         const nlohmann::json& json);
-    http::response<http::string_body> createErrorResponse(int code, 
-                                                          const std::string& message);
-    std::string extractIdFromPath(const std::string& path);
-    std::string extractQueryParam(const std::string& target, const std::string& param);
+                                                         const nlohmann::json& json,
+                                                         utils::MediaType type = utils::MediaType::Json);
+    http::response<http::string_body> createProductResponse(http::status status,
+                                                            const dto::ProductResponse& product,
+                                                            utils::MediaType type);
+};
+
+/**
+ * RequestHandlerOptions - Where RequestHandler runs route handlers
+ */
+struct RequestHandlerOptions {
+    // Threads for handlers that may block on the repository; 0 runs them
+    // on the I/O thread that read the request
+    std::size_t blockingThreads{0};
+    // Requests waiting for a blocking thread before new ones are shed with
+    // a 503; 0 means unbounded
+    std::size_t maxQueued{0};
 };
 
 /**
  * RequestHandler - Routes requests to appropriate handlers
+ * With blocking threads configured, handleAsync() runs repository-bound
+ * requests on its own pool so that a slow database call holds a pool
+ * thread instead of an I/O thread; both pools are sized independently.
+ * Requests are admitted before they are queued, so the admission limits
+ * bound queued and running requests together.
  */
 class RequestHandler {
 public:
-    explicit RequestHandler(std::shared_ptr<ProductHandler> productHandler);
+    using Response = http::response<http::string_body>;
+    using Completion = std::function<void(Response)>;
 
-    http::response<http::string_body> 
-        handle(const http::request<http::string_body>& req);
+    explicit RequestHandler(std::shared_ptr<ProductHandler> productHandler,
+                            RequestHandlerOptions options = {});
+    // Waits for requests still running on the blocking pool
+    ~RequestHandler();
+
+    Response handle(const http::request<http::string_body>& req);
+
+    // Passes the response for req to done, called on this thread when the
+    // request is handled in place and on a blocking thread otherwise. req
+    // must stay alive and unmodified until done is called.
+    void handleAsync(const http::request<http::string_body>& req, Completion done);
 
 private:
     std::shared_ptr<ProductHandler> productHandler_;
+    RequestHandlerOptions options_;
+    std::unique_ptr<boost::asio::thread_pool> blockingPool_;
+
+    std::atomic<std::size_t> queued_{0};
+    utils::Gauge& queueDepth_;
+    utils::Histogram& queueWait_;
+    utils::Counter& rejected_;
+
+    // handleAdmitted(), with an exception turned into a 500
+    Response run(const http::request<http::string_body>& req,
+                 const ProductHandler::Admission& admission);
 };
 
 } // namespace adapters
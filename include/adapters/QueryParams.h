@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace adapters {
+
+/**
+ * QueryParams - Single-pass, percent-decoding query string parser
+ * Names and values are views into the original query string. Only when
+ * a component contains '%' or '+' is it decoded, into one buffer sized
+ * up front so the views stay valid. Parameters beyond kMaxParams are
+ * ignored; for repeated names the first occurrence wins.
+ */
+class QueryParams {
+public:
+    static constexpr std::size_t kMaxParams = 16;
+
+    // Accepts either a full request target ("/path?a=b") or a bare query
+    explicit QueryParams(std::string_view target);
+
+    QueryParams(const QueryParams&) = delete;
+    QueryParams& operator=(const QueryParams&) = delete;
+
+    // Returns the decoded value, or an empty view when absent
+    std::string_view get(std::string_view name) const;
+    bool has(std::string_view name) const;
+
+    // Percent-encodes a value for use in a query string
+    static std::string encode(std::string_view value);
+
+private:
+    std::array<std::pair<std::string_view, std::string_view>, kMaxParams> params_{};
+    std::size_t count_{0};
+    std::string decoded_;
+
+    std::string_view decode(std::string_view component, std::size_t capacity);
+};
+
+} // namespace adapters
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "domain/CatalogGenerations.h"
+#include "utils/Compression.h"
+#include "utils/Serialization.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace adapters {
+
+/**
+ * ResponseCacheOptions - Sizing and expiry for ResponseCache
+ */
+struct ResponseCacheOptions {
+    // Budget for keys and bodies (plain and compressed) across all shards
+    std::size_t maxBytes{64 * 1024 * 1024};
+    std::size_t shards{16};
+    // Bounds how long writes made by other instances can go unseen
+    std::chrono::milliseconds ttl{10000};
+    // When enabled, bodies of at least minSize also get a gzip copy
+    utils::CompressionOptions compression;
+};
+
+/**
+ * CachedResponse - A serialized list response, ready to be copied out
+ */
+struct CachedResponse {
+    std::string body;
+    utils::MediaType type{utils::MediaType::Json};
+    // Empty when the body was not worth compressing
+    std::string gzipBody;
+    std::string etag;
+    // Sent along with the body, e.g. the next page link
+    std::vector<std::pair<std::string, std::string>> headers;
+};
+
+/**
+ * ResponseCacheStats - Snapshot of ResponseCache counters
+ */
+struct ResponseCacheStats {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    // Entries found but built before the latest write to their category
+    std::uint64_t stale{0};
+    std::uint64_t evictions{0};
+    std::size_t entries{0};
+    std::size_t bytes{0};
+};
+
+/**
+ * ResponseCache - Serialized response bodies of list queries
+ * A hit skips the repository, the DTOs and serialization. Each entry
+ * records the category generation it was read under and is dropped on
+ * lookup once that category has changed since. Shards evict their
+ * least recently used entries to stay within maxBytes / shards.
+ */
+class ResponseCache {
+public:
+    using Stamp = domain::CatalogGenerations::Stamp;
+
+    ResponseCache(ResponseCacheOptions options,
+                  std::shared_ptr<const domain::CatalogGenerations> generations);
+
+    // Taken before the data for a response is read, then passed to put()
+    Stamp stamp(const std::string& category) const;
+
+    std::shared_ptr<const CachedResponse> get(const std::string& key,
+                                              const std::string& category);
+
+    // Adds the gzip copy when configured; entries too large for a shard
+    // are not kept
+    void put(const std::string& key, const Stamp& stamp, CachedResponse response);
+
+    ResponseCacheStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const CachedResponse> response;
+        Stamp stamp;
+        Clock::time_point expiresAt;
+        std::size_t bytes;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        std::size_t bytes{0};
+    };
+
+    ResponseCacheOptions options_;
+    std::shared_ptr<const domain::CatalogGenerations> generations_;
+    std::vector<Shard> shards_;
+    std::size_t shardBudget_;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> stale_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+
+    Shard& shardFor(const std::string& key);
+    // Caller holds the shard lock
+    void erase(Shard& shard, std::list<Entry>::iterator it);
+};
+
+} // namespace adapters
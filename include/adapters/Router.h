@@ -0,0 +1,92 @@
+#pragma once
+
+#include <boost/beast/http.hpp>
+#include <array>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace adapters {
+
+namespace http = boost::beast::http;
+
+/**
+ * RouteParams - Path parameters captured by Router::match
+ * Values are views into the request target and live as long as the request
+ */
+class RouteParams {
+public:
+    static constexpr std::size_t kMaxParams = 4;
+
+    std::string_view get(std::string_view name) const {
+        for (std::size_t i = 0; i < count_; ++i) {
+            if (names_[i] == name) {
+                return values_[i];
+            }
+        }
+        return {};
+    }
+
+    void add(std::string_view name, std::string_view value) {
+        if (count_ < kMaxParams) {
+            names_[count_] = name;
+            values_[count_] = value;
+            ++count_;
+        }
+    }
+
+    void clear() { count_ = 0; }
+
+private:
+    std::array<std::string_view, kMaxParams> names_{};
+    std::array<std::string_view, kMaxParams> values_{};
+    std::size_t count_{0};
+};
+
+/**
+ * Router - Route table dispatching on (verb, path)
+ * Patterns are split into segments once, when routes are added; matching
+ * walks the request path as string_views and never allocates.
+ *
+ * Pattern syntax: literal segments, "{name}" for any non-empty segment,
+ * "{name:oid}" for a 24-hex-character ObjectId.
+ */
+class Router {
+public:
+    using Request = http::request<http::string_body>;
+    using Response = http::response<http::string_body>;
+    using Handler = std::function<Response(const Request&, const RouteParams&)>;
+
+    struct Route {
+        http::verb method;
+        std::string pattern;
+        Handler handler;
+        std::size_t index;  // position in the table, for per-route bookkeeping
+    };
+
+    void add(http::verb method, std::string_view pattern, Handler handler);
+
+    // Returns the first matching route, or nullptr when none matches
+    const Route* match(http::verb method, std::string_view path, RouteParams& params) const;
+
+    std::size_t size() const { return entries_.size(); }
+    const Route& route(std::size_t index) const { return entries_[index].route; }
+
+private:
+    enum class SegmentKind { Literal, Param, ObjectIdParam };
+
+    struct Segment {
+        SegmentKind kind;
+        std::string text;   // literal text or parameter name
+    };
+
+    struct Entry {
+        Route route;
+        std::vector<Segment> segments;
+    };
+
+    std::vector<Entry> entries_;
+};
+
+} // namespace adapters
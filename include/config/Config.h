@@ -2,6 +2,9 @@
 
 #include <string>
 #include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include <sys/resource.h>
 
 namespace config {
 
@@ -18,7 +21,157 @@ public:
     static unsigned short getServerPort() {
         return std::stoi(getEnv("SERVER_PORT", "8080"));
     }
+
+    // Number of threads serving HTTP traffic (defaults to one per core)
+    static std::size_t getServerThreads() {
+        auto threads = getInt("SERVER_THREADS", 0);
+        if (threads > 0) {
+            return static_cast<std::size_t>(threads);
+        }
+        auto cores = std::thread::hardware_concurrency();
+        return cores > 0 ? cores : 1;
+    }
+
+    // "shared": all threads run one io_context
+    // "per-core": each thread owns an io_context and a SO_REUSEPORT listener
+    static std::string getServerExecutionModel() {
+        return getEnv("SERVER_EXECUTION_MODEL", "shared");
+    }
+
+    static bool getServerCpuPinning() {
+        return getBool("SERVER_CPU_PINNING", false);
+    }
+    
+    // Threads running handlers that may block on the repository, apart
+    // from the I/O threads; 0 handles requests on the I/O threads. The
+    // default (-1) matches MONGO_POOL_MAX_SIZE with the mongo backend,
+    // whose calls block, and is 0 with the in-memory ones.
+    static int getBlockingThreads() {
+        return getInt("HTTP_BLOCKING_THREADS", -1);
+    }
+
+    // Requests waiting for a blocking thread before new ones get a 503;
+    // 0 means unbounded
+    static std::size_t getBlockingQueueMax() {
+        return getSize("HTTP_BLOCKING_QUEUE_MAX", 0);
+    }
+    
+    // Keep-alive: requests served per connection before it is closed
+    static std::size_t getKeepAliveMaxRequests() {
+        return getSize("HTTP_KEEPALIVE_MAX_REQUESTS", 1000);
+    }
+
+    // Keep-alive: seconds a connection may sit idle waiting for a request
+    static int getKeepAliveTimeoutSeconds() {
+        return getSeconds("HTTP_KEEPALIVE_TIMEOUT_SECONDS", 30);
+    }
+    
+    // Per-phase deadlines: receiving a request's header, its body, and
+    // sending the response
+    static int getHeaderTimeoutSeconds() {
+        return getSeconds("HTTP_HEADER_TIMEOUT_SECONDS", 10);
+    }
+
+    static int getBodyTimeoutSeconds() {
+        return getSeconds("HTTP_BODY_TIMEOUT_SECONDS", 30);
+    }
+
+    static int getWriteTimeoutSeconds() {
+        return getSeconds("HTTP_WRITE_TIMEOUT_SECONDS", 30);
+    }
+
+    // Open connections before accepting pauses (defaults to three quarters
+    // of the open file limit, leaving the rest for MongoDB and logs)
+    static std::size_t getMaxConnections() {
+        auto connections = getInt("HTTP_MAX_CONNECTIONS", 0);
+        if (connections > 0) {
+            return static_cast<std::size_t>(connections);
+        }
+        rlimit limit{};
+        if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) {
+            return 0;
+        }
+        return static_cast<std::size_t>(limit.rlim_cur / 4 * 3);
+    }
+
+    static std::size_t getMaxBodyBytes() {
+        return getSize("HTTP_MAX_BODY_BYTES", 1024 * 1024);
+    }
+    
+    // gzip / deflate response bodies for clients that send Accept-Encoding
+    static bool getCompressionEnabled() {
+        return getBool("HTTP_COMPRESSION_ENABLED", true);
+    }
+
+    // zlib level: 1 is fastest, 9 gives the smallest bodies
+    static int getCompressionLevel() {
+        return getInt("HTTP_COMPRESSION_LEVEL", 6);
+    }
+
+    // Bodies below this many bytes are not worth compressing
+    static std::size_t getCompressionMinBytes() {
+        return getSize("HTTP_COMPRESSION_MIN_BYTES", 1024);
+    }
+    
+    // Admission control: requests handled at once before new ones get a
+    // 503; 0 means unlimited. /health and /metrics are never shed.
+    static std::size_t getAdmissionMaxInFlight() {
+        return getSize("ADMISSION_MAX_IN_FLIGHT", 0);
+    }
+
+    static std::size_t getAdmissionMaxInFlightPerRoute() {
+        return getSize("ADMISSION_MAX_IN_FLIGHT_PER_ROUTE", 0);
+    }
+
+    // Per-route overrides, e.g. "GET /products=16,POST /products/_bulk=2"
+    static std::string getAdmissionRouteLimits() {
+        return getEnv("ADMISSION_ROUTE_LIMITS", "");
+    }
+
+    static int getAdmissionRetryAfterSeconds() {
+        return getInt("ADMISSION_RETRY_AFTER_SECONDS", 1);
+    }
+
+    // AIMD: shrink the global limit while repository calls are slower than
+    // the target, grow it back while they are faster
+    static bool getAdmissionAdaptive() {
+        return getBool("ADMISSION_ADAPTIVE", false);
+    }
+
+    static int getAdmissionLatencyTargetMs() {
+        return getInt("ADMISSION_LATENCY_TARGET_MS", 50);
+    }
+
+    static std::size_t getAdmissionMinLimit() {
+        return getSize("ADMISSION_MIN_LIMIT", 4);
+    }
+    
+    // GET /products page size when no limit is given
+    static std::size_t getDefaultPageSize() {
+        return getSize("PRODUCTS_DEFAULT_PAGE_SIZE", 100);
+    }
+
+    // Upper bound on the limit a client may request
+    static std::size_t getMaxPageSize() {
+        return getSize("PRODUCTS_MAX_PAGE_SIZE", 1000);
+    }
+
+    // Most operations accepted by one POST /products/_bulk request
+    static std::size_t getMaxBulkOperations() {
+        return getSize("BULK_MAX_OPERATIONS", 1000);
+    }
     
+    // "mongo", "memory" (in-process store, nothing persisted) or
+    // "materialized" (reads from an in-process copy kept in sync with
+    // MongoDB through a change stream; needs a replica set)
+    static std::string getRepositoryBackend() {
+        return getEnv("REPOSITORY_BACKEND", "mongo");
+    }
+
+    static std::size_t getMemoryRepositoryShards() {
+        return getSize("MEMORY_REPOSITORY_SHARDS", 16);
+    }
+
     static std::string getMongoUri() {
         return getEnv("MONGO_URI", "mongodb://localhost:27017");
     }
@@ -27,12 +180,120 @@ public:
         return getEnv("DATABASE_NAME", "product_catalog");
     }
     
+    static std::size_t getMongoPoolMinSize() {
+        return getSize("MONGO_POOL_MIN_SIZE", 0);
+    }
+
+    static std::size_t getMongoPoolMaxSize() {
+        return getSize("MONGO_POOL_MAX_SIZE", 100);
+    }
+    
+    // Read-through product cache in front of the repository
+    static bool getProductCacheEnabled() {
+        return getBool("PRODUCT_CACHE_ENABLED", true);
+    }
+
+    static std::size_t getProductCacheCapacity() {
+        return getSize("PRODUCT_CACHE_CAPACITY", 10000);
+    }
+
+    static std::size_t getProductCacheListCapacity() {
+        return getSize("PRODUCT_CACHE_LIST_CAPACITY", 256);
+    }
+
+    static std::size_t getProductCacheShards() {
+        return getSize("PRODUCT_CACHE_SHARDS", 16);
+    }
+
+    static int getProductCacheTtlMs() {
+        return getInt("PRODUCT_CACHE_TTL_MS", 10000);
+    }
+
+    static int getProductCacheNegativeTtlMs() {
+        return getInt("PRODUCT_CACHE_NEGATIVE_TTL_MS", 2000);
+    }
+    
+    // Serialized GET /products pages, invalidated per category on writes
+    static bool getResponseCacheEnabled() {
+        return getBool("RESPONSE_CACHE_ENABLED", true);
+    }
+
+    static std::size_t getResponseCacheMaxBytes() {
+        return getSize("RESPONSE_CACHE_MAX_BYTES", 64 * 1024 * 1024);
+    }
+
+    static int getResponseCacheTtlMs() {
+        return getInt("RESPONSE_CACHE_TTL_MS", 10000);
+    }
+    
+    // trace, debug, info, warn, error, critical or off
+    static std::string getLogLevel() {
+        return getEnv("LOG_LEVEL", "info");
+    }
+
+    // Write log records from a background thread instead of the caller
+    static bool getLogAsync() {
+        return getBool("LOG_ASYNC", false);
+    }
+
+    static std::size_t getLogAsyncQueueSize() {
+        return getSize("LOG_ASYNC_QUEUE_SIZE", 8192);
+    }
+
+    // "block" or "drop" (overwrite the oldest queued record) when the queue is full
+    static std::string getLogAsyncOverflow() {
+        return getEnv("LOG_ASYNC_OVERFLOW", "block");
+    }
+
+    // Fraction of requests written to the access log; 5xx responses are always logged
+    static double getAccessLogSampleRate() {
+        return getDouble("ACCESS_LOG_SAMPLE_RATE", 1.0);
+    }
+
     static void validate() {
         // Ensure required environment variables are set
         getServerAddress();
         getServerPort();
+        getServerThreads();
+        auto model = getServerExecutionModel();
+        if (model != "shared" && model != "per-core") {
+            throw std::invalid_argument("SERVER_EXECUTION_MODEL must be \"shared\" or \"per-core\", got \"" +
+                                        model + "\"");
+        }
+        auto backend = getRepositoryBackend();
+        if (backend != "mongo" && backend != "memory" && backend != "materialized") {
+            throw std::invalid_argument(
+                "REPOSITORY_BACKEND must be \"mongo\", \"memory\" or \"materialized\", got \"" +
+                backend + "\"");
+        }
         getMongoUri();
         getDatabaseName();
+
+        getKeepAliveTimeoutSeconds();
+        getHeaderTimeoutSeconds();
+        getBodyTimeoutSeconds();
+        getWriteTimeoutSeconds();
+
+        // Sizes are read where they are used, some only on some backends;
+        // check them all up front so a bad value always fails startup
+        getBlockingQueueMax();
+        getKeepAliveMaxRequests();
+        getMaxBodyBytes();
+        getCompressionMinBytes();
+        getAdmissionMaxInFlight();
+        getAdmissionMaxInFlightPerRoute();
+        getAdmissionMinLimit();
+        getDefaultPageSize();
+        getMaxPageSize();
+        getMaxBulkOperations();
+        getMemoryRepositoryShards();
+        getMongoPoolMinSize();
+        getMongoPoolMaxSize();
+        getProductCacheCapacity();
+        getProductCacheListCapacity();
+        getProductCacheShards();
+        getResponseCacheMaxBytes();
+        getLogAsyncQueueSize();
     }
 
 private:
@@ -40,6 +301,43 @@ private:
         const char* val = std::getenv(key.c_str());
         return val ? std::string(val) : defaultValue;
     }
+
+    static int getInt(const std::string& key, int defaultValue) {
+        auto val = getEnv(key);
+        return val.empty() ? defaultValue : std::stoi(val);
+    }
+
+    // Counts and sizes; a negative value is a startup error rather than
+    // a huge size_t
+    static std::size_t getSize(const std::string& key, std::size_t defaultValue) {
+        auto val = getInt(key, static_cast<int>(defaultValue));
+        if (val < 0) {
+            throw std::invalid_argument(key + " must not be negative");
+        }
+        return static_cast<std::size_t>(val);
+    }
+
+    // Connection deadlines; zero or less would expire before any I/O
+    static int getSeconds(const std::string& key, int defaultValue) {
+        auto val = getInt(key, defaultValue);
+        if (val <= 0) {
+            throw std::invalid_argument(key + " must be positive");
+        }
+        return val;
+    }
+
+    static double getDouble(const std::string& key, double defaultValue) {
+        auto val = getEnv(key);
+        return val.empty() ? defaultValue : std::stod(val);
+    }
+
+    static bool getBool(const std::string& key, bool defaultValue) {
+        auto val = getEnv(key);
+        if (val.empty()) {
+            return defaultValue;
+        }
+        return val == "1" || val == "true" || val == "TRUE" || val == "yes";
+    }
 };
 
 } // namespace config
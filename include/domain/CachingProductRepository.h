@@ -0,0 +1,113 @@
+#pragma once
+
+#include "domain/CatalogGenerations.h"
+#include "domain/ProductRepository.h"
+#include "utils/ShardedLruCache.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
+namespace domain {
+
+/**
+ * ProductCacheOptions - Sizing and expiry for CachingProductRepository
+ */
+struct ProductCacheOptions {
+    std::size_t productCapacity{10000};
+    std::size_t listCapacity{256};
+    std::size_t shards{16};
+    std::chrono::milliseconds ttl{10000};
+    std::chrono::milliseconds negativeTtl{2000};
+};
+
+/**
+ * CachingProductRepository - Read-through cache decorator
+ * Wraps any ProductRepository and serves findById, findByIds, per-category
+ * findAll and findPage from sharded LRU caches. Missing ids are cached negatively
+ * for a shorter time. Writes go straight to the wrapped repository
+ * and invalidate the entries they affect.
+ *
+ * Products are keyed by normalized id. Each write bumps a version for
+ * its id before erasing it, and a read-through put only lands if that
+ * version did not move during the repository read, so a read racing a
+ * write cannot cache the snapshot the write replaced.
+ *
+ * List keys embed a per-category generation, so invalidating a category
+ * is a counter bump; superseded entries simply age out of the LRU. The
+ * generations can be shared with caches further up, which then see the
+ * same invalidations.
+ */
+class CachingProductRepository : public ProductRepository {
+public:
+    CachingProductRepository(std::shared_ptr<ProductRepository> inner,
+                             ProductCacheOptions options = {},
+                             std::shared_ptr<CatalogGenerations> generations = nullptr);
+
+    std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>> 
+        findAll(const std::string& category = "") override;
+
+    std::pair<ProductPage, std::optional<utils::AppError>>
+        findPage(const std::string& category, const std::string& afterId,
+                 std::size_t limit) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>> 
+        findById(const std::string& id) override;
+
+    std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+        findByIds(const std::vector<std::string>& ids) override;
+
+    std::pair<std::string, std::optional<utils::AppError>> 
+        create(const Product& product) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        update(const Product& product) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        patch(const std::string& id, const ProductPatch& patch) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        reserveStock(const std::string& id, int quantity) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        releaseStock(const std::string& id, int quantity) override;
+
+    std::optional<utils::AppError> 
+        deleteById(const std::string& id) override;
+
+    std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+        bulkWrite(const std::vector<BulkOperation>& operations) override;
+
+    bool exists(const std::string& id) override;
+
+    utils::CacheStats getProductCacheStats() const { return products_.stats(); }
+    utils::CacheStats getListCacheStats() const { return lists_.stats(); }
+
+private:
+    std::shared_ptr<ProductRepository> inner_;
+    ProductCacheOptions options_;
+
+    // A null snapshot records that the id does not exist
+    utils::ShardedLruCache<std::string, ProductPtr> products_;
+    utils::ShardedLruCache<std::string, std::shared_ptr<const ProductPage>> lists_;
+
+    std::shared_ptr<CatalogGenerations> generations_;
+
+    // Per-id write versions, striped by key hash
+    static constexpr std::size_t kVersionStripes = 256;
+    std::array<std::atomic<std::uint64_t>, kVersionStripes> versions_{};
+
+    std::atomic<std::uint64_t>& versionOf(const std::string& key);
+    void putProduct(const std::string& key, ProductPtr product, std::uint64_t version);
+    void eraseProduct(const std::string& key);
+    std::string listKey(const std::string& category, const std::string& suffix) const;
+    void invalidateCategory(const std::string& category);
+    void invalidateAllLists();
+    void invalidateProduct(const std::string& id, const std::string& category);
+    void invalidateStockChange(
+        const std::string& id,
+        const std::pair<ProductPtr, std::optional<utils::AppError>>& result);
+};
+
+} // namespace domain
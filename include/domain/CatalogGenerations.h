@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace domain {
+
+/**
+ * CatalogGenerations - Per-category change counters for list caches
+ * Stores bump the categories a write touches ("" is the unfiltered
+ * listing) once the write is visible, and bumpAll() when they cannot
+ * tell. A list cached under a stamp taken before it was read stays
+ * valid exactly while current() still returns that stamp.
+ */
+class CatalogGenerations {
+public:
+    struct Stamp {
+        std::uint64_t epoch{0};
+        std::uint64_t generation{0};
+
+        bool operator==(const Stamp& other) const {
+            return epoch == other.epoch && generation == other.generation;
+        }
+        bool operator!=(const Stamp& other) const { return !(*this == other); }
+    };
+
+    Stamp current(const std::string& category) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = generations_.find(category);
+        return Stamp{epoch_, it != generations_.end() ? it->second : 0};
+    }
+
+    void bump(const std::string& category) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        ++generations_[category];
+    }
+
+    // A product in category changed: its category list and the full listing
+    void bumpProduct(const std::string& category) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        ++generations_[""];
+        ++generations_[category];
+    }
+
+    void bumpAll() {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        ++epoch_;
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::uint64_t> generations_;
+    std::uint64_t epoch_{0};
+};
+
+} // namespace domain
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "domain/CatalogGenerations.h"
+#include "domain/ProductRepository.h"
+#include <memory>
+#include <set>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace domain {
+
+/**
+ * InMemoryProductRepository - Secondary Adapter (in-process store)
+ * Products live in a hash map split into independently locked shards,
+ * keyed by ObjectId. Each shard also keeps its ids ordered, overall and
+ * per category, so a write only ever locks its own shard. findAll and
+ * findPage merge the shards' indexes in _id order without scanning.
+ *
+ * Behaves like ProductRepositoryMongo: generated ObjectId-format ids,
+ * ids matched case-insensitively, and the same AppError codes and
+ * messages. A malformed id is reported as a database error, as the
+ * driver's failure to parse it would be.
+ *
+ * Every change bumps the affected categories in generations, if given.
+ * Reads share the stored snapshots; writes replace them.
+ */
+class InMemoryProductRepository : public ProductRepository {
+public:
+    explicit InMemoryProductRepository(std::size_t shardCount = 16,
+                                       std::shared_ptr<CatalogGenerations> generations = nullptr);
+
+    std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+        findAll(const std::string& category = "") override;
+
+    std::pair<ProductPage, std::optional<utils::AppError>>
+        findPage(const std::string& category, const std::string& afterId,
+                 std::size_t limit) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        findById(const std::string& id) override;
+
+    std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+        findByIds(const std::vector<std::string>& ids) override;
+
+    std::pair<std::string, std::optional<utils::AppError>>
+        create(const Product& product) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        update(const Product& product) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        patch(const std::string& id, const ProductPatch& patch) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        reserveStock(const std::string& id, int quantity) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        releaseStock(const std::string& id, int quantity) override;
+
+    std::optional<utils::AppError>
+        deleteById(const std::string& id) override;
+
+    std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+        bulkWrite(const std::vector<BulkOperation>& operations) override;
+
+    bool exists(const std::string& id) override;
+
+    // Inserts or replaces a product under its own id, which must be a
+    // valid ObjectId, keeping the snapshot as given. Used to mirror
+    // another store.
+    void put(ProductPtr product);
+
+    std::size_t size() const;
+
+private:
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, ProductPtr> products;
+        // Ids of this shard's products in _id order, overall and per category
+        std::set<std::string> ids;
+        std::unordered_map<std::string, std::set<std::string>> byCategory;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::shared_ptr<CatalogGenerations> generations_;
+
+    Shard& shardFor(const std::string& id) const;
+
+    // Up to limit products after afterId (all when limit is 0), in _id
+    // order. Read-locks every shard, in shard order, for one consistent
+    // merge; writers only ever hold their own shard.
+    std::vector<ProductPtr> ordered(const std::string& category, const std::string& afterId,
+                                    std::size_t limit) const;
+    ProductPtr get(const std::string& id) const;
+
+    // Applies change to a copy of the stored product under its shard lock,
+    // stores the copy as the new snapshot and keeps the category index in
+    // step. change returns an error to refuse the change, leaving the
+    // product untouched.
+    template <typename Change>
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        modify(const std::string& id, Change&& change);
+
+    // Index upkeep; the caller holds the shard's lock exclusively
+    static void indexInsert(Shard& shard, const std::string& id, const std::string& category);
+    static void indexErase(Shard& shard, const std::string& id, const std::string& category);
+    static void indexMove(Shard& shard, const std::string& id, const std::string& from,
+                          const std::string& to);
+    static void eraseFromCategory(Shard& shard, const std::string& id,
+                                  const std::string& category);
+    // Bumps the generations of the categories a product left and entered
+    void changed(const std::string& from, const std::string& to);
+};
+
+} // namespace domain
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "domain/ProductRepository.h"
+#include "utils/Metrics.h"
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace domain {
+
+/**
+ * InstrumentedProductRepository - Metrics decorator
+ * Records the latency of every call to the wrapped repository, per
+ * method, and counts calls that fail with a database error. Series are
+ * resolved once at construction; recording is lock-free. An optional
+ * observer also sees every latency, e.g. to drive admission control.
+ */
+class InstrumentedProductRepository : public ProductRepository {
+public:
+    explicit InstrumentedProductRepository(std::shared_ptr<ProductRepository> inner,
+                                           utils::MetricsRegistry& registry = utils::MetricsRegistry::global());
+
+    std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+        findAll(const std::string& category = "") override;
+
+    std::pair<ProductPage, std::optional<utils::AppError>>
+        findPage(const std::string& category, const std::string& afterId,
+                 std::size_t limit) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        findById(const std::string& id) override;
+
+    std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+        findByIds(const std::vector<std::string>& ids) override;
+
+    std::pair<std::string, std::optional<utils::AppError>>
+        create(const Product& product) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        update(const Product& product) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        patch(const std::string& id, const ProductPatch& patch) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        reserveStock(const std::string& id, int quantity) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        releaseStock(const std::string& id, int quantity) override;
+
+    std::optional<utils::AppError>
+        deleteById(const std::string& id) override;
+
+    std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+        bulkWrite(const std::vector<BulkOperation>& operations) override;
+
+    bool exists(const std::string& id) override;
+
+    using LatencyObserver = std::function<void(std::chrono::steady_clock::duration)>;
+
+    // Not synchronized with calls in progress: set before serving requests
+    void setLatencyObserver(LatencyObserver observer) { observer_ = std::move(observer); }
+
+private:
+    enum Operation {
+        FindAll, FindPage, FindById, FindByIds, Create, Update, Patch, ReserveStock,
+        ReleaseStock, DeleteById, BulkWrite, Exists,
+        kOperationCount
+    };
+
+    struct OperationMetrics {
+        utils::Histogram* latency{nullptr};
+        utils::Counter* errors{nullptr};
+    };
+
+    std::shared_ptr<ProductRepository> inner_;
+    std::array<OperationMetrics, kOperationCount> metrics_;
+    LatencyObserver observer_;
+
+    template <typename Call>
+    auto timed(Operation operation, Call&& call);
+};
+
+} // namespace domain
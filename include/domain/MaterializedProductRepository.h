@@ -0,0 +1,142 @@
+#pragma once
+
+#include "domain/InMemoryProductRepository.h"
+#include <bsoncxx/document/value.hpp>
+#include <mongocxx/client.hpp>
+#include <mongocxx/collection.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace domain {
+
+/**
+ * MaterializedCatalogStats - Snapshot of the change stream follower
+ * Used for the replication lag and resume position metrics
+ */
+struct MaterializedCatalogStats {
+    std::size_t products{0};
+    std::uint64_t eventsApplied{0};
+    std::uint64_t resyncs{0};
+    std::uint64_t reconnects{0};
+    bool streaming{false};
+    // Time between a change being committed and applied here, for the
+    // latest event
+    double lagSeconds{0.0};
+    // Cluster time (seconds) of the latest event applied
+    std::uint32_t resumeClusterTime{0};
+    // Extended JSON of the resume token the stream would restart from
+    std::string resumeToken;
+};
+
+/**
+ * MaterializedProductRepository - Secondary Adapter (read replica in process)
+ * Serves every read from an InMemoryProductRepository that mirrors the
+ * products collection: loaded in full at start, then kept in sync by
+ * tailing a change stream on a dedicated client. Writes go to the
+ * wrapped repository (normally ProductRepositoryMongo) and reach the
+ * mirror through the stream, so reads lag writes by the stream delay.
+ *
+ * After a disconnect the stream resumes from the last resume token. If
+ * the token is no longer in the oplog, or the collection is dropped or
+ * renamed, the mirror is rebuilt from a fresh scan and swapped in whole.
+ *
+ * Change streams need a replica set (a single node is enough).
+ *
+ * Applied events bump generations, so list caches built on top also see
+ * writes made by other instances.
+ */
+class MaterializedProductRepository : public ProductRepository {
+public:
+    MaterializedProductRepository(const std::string& connectionString,
+                                  const std::string& databaseName,
+                                  std::shared_ptr<ProductRepository> writes,
+                                  std::size_t shardCount = 16,
+                                  std::shared_ptr<CatalogGenerations> generations = nullptr);
+    ~MaterializedProductRepository() override;
+
+    MaterializedProductRepository(const MaterializedProductRepository&) = delete;
+    MaterializedProductRepository& operator=(const MaterializedProductRepository&) = delete;
+
+    // Starts following the collection; returns once the first full load
+    // has completed (retrying until it does)
+    void start();
+    void stop();
+
+    std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+        findAll(const std::string& category = "") override;
+
+    std::pair<ProductPage, std::optional<utils::AppError>>
+        findPage(const std::string& category, const std::string& afterId,
+                 std::size_t limit) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        findById(const std::string& id) override;
+
+    std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+        findByIds(const std::vector<std::string>& ids) override;
+
+    std::pair<std::string, std::optional<utils::AppError>>
+        create(const Product& product) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        update(const Product& product) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        patch(const std::string& id, const ProductPatch& patch) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        reserveStock(const std::string& id, int quantity) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        releaseStock(const std::string& id, int quantity) override;
+
+    std::optional<utils::AppError>
+        deleteById(const std::string& id) override;
+
+    std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+        bulkWrite(const std::vector<BulkOperation>& operations) override;
+
+    bool exists(const std::string& id) override;
+
+    MaterializedCatalogStats getStats() const;
+
+private:
+    std::shared_ptr<ProductRepository> writes_;
+    std::string databaseName_;
+    std::size_t shardCount_;
+    std::shared_ptr<CatalogGenerations> generations_;
+
+    // Only the follower thread uses the client
+    mongocxx::client client_;
+
+    // Replaced as a whole on resync; readers take their own reference
+    std::shared_ptr<InMemoryProductRepository> store_;
+
+    std::thread follower_;
+    std::atomic<bool> stopping_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    bool loaded_{false};
+    MaterializedCatalogStats stats_;
+
+    // Follower thread only; empty forces a full resync on the next open
+    std::optional<bsoncxx::document::value> resumeToken_;
+
+    std::shared_ptr<InMemoryProductRepository> store() const;
+
+    void follow();
+    void resync(mongocxx::collection& collection);
+    // Returns false when the stream can no longer be resumed
+    bool apply(const bsoncxx::document::view& event, InMemoryProductRepository& store);
+    void rememberResumeToken(const bsoncxx::document::view& token);
+    void setStreaming(bool streaming);
+    // Sleeps up to delay, waking early on stop
+    void pause(std::chrono::milliseconds delay);
+};
+
+} // namespace domain
@@ -3,9 +3,18 @@
 #include <string>
 #include <memory>
 #include <optional>
+#include <string_view>
 
 namespace domain {
 
+// Categories are few and shared by many products, so each distinct name
+// is stored once, for the life of the process, and products refer to it.
+// Names come from request bodies, failed writes included, so at most
+// kMaxInternedCategories are kept; past that internCategory() returns
+// nullptr and products hold their own copy.
+constexpr std::size_t kMaxInternedCategories = 4096;
+const std::string* internCategory(std::string_view category);
+
 /**
  * Product entity - Core domain model
  * This represents a product in our catalog
@@ -13,26 +22,25 @@ namespace domain {
 class Product {
 public:
     Product() = default;
-    Product(const std::string& id, const std::string& name, 
-            const std::string& description, double price, int stock,
-            const std::string& category);
+    Product(std::string id, std::string name, std::string description,
+            double price, int stock, std::string_view category);
 
     // Getters
-    std::string getId() const { return id_; }
-    std::string getName() const { return name_; }
-    std::string getDescription() const { return description_; }
+    const std::string& getId() const { return id_; }
+    const std::string& getName() const { return name_; }
+    const std::string& getDescription() const { return description_; }
     double getPrice() const { return price_; }
     int getStock() const { return stock_; }
-    std::string getCategory() const { return category_; }
-    std::string getStatus() const;
+    const std::string& getCategory() const { return *category_; }
+    std::string_view getStatus() const;
 
     // Setters
-    void setId(const std::string& id) { id_ = id; }
-    void setName(const std::string& name) { name_ = name; }
-    void setDescription(const std::string& description) { description_ = description; }
+    void setId(std::string id) { id_ = std::move(id); }
+    void setName(std::string name) { name_ = std::move(name); }
+    void setDescription(std::string description) { description_ = std::move(description); }
     void setPrice(double price) { price_ = price; }
     void setStock(int stock) { stock_ = stock; }
-    void setCategory(const std::string& category) { category_ = category; }
+    void setCategory(std::string_view category);
 
     // Business logic
     bool isAvailable() const { return stock_ > 0; }
@@ -46,7 +54,17 @@ private:
     std::string description_;
     double price_{0.0};
     int stock_{0};
-    std::string category_;
+    const std::string* category_{internCategory({})};
+    // Owns the name category_ points at when it could not be interned
+    std::shared_ptr<const std::string> ownedCategory_;
 };
 
+/**
+ * ProductPtr - Immutable product snapshot
+ * Repositories and caches hand out the snapshot they hold instead of a
+ * copy. A change stores a new snapshot, so one already handed out never
+ * changes under its reader.
+ */
+using ProductPtr = std::shared_ptr<const Product>;
+
 } // namespace domain
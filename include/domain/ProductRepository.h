@@ -9,35 +9,116 @@
 
 namespace domain {
 
+/**
+ * ProductPage - One page of a keyset-paginated listing
+ * nextCursor is the id to pass as "after" for the following page,
+ * or empty when this is the last page
+ */
+struct ProductPage {
+    std::vector<ProductPtr> items;
+    std::string nextCursor;
+};
+
+/**
+ * ProductPatch - Partial update of a product
+ * Only the fields that are set are written; the rest keep their values
+ */
+struct ProductPatch {
+    std::optional<std::string> name;
+    std::optional<std::string> description;
+    std::optional<double> price;
+    std::optional<int> stock;
+    std::optional<std::string> category;
+
+    bool empty() const {
+        return !name && !description && !price && !stock && !category;
+    }
+};
+
+/**
+ * BulkOperation - One create, update or delete within a bulk write
+ * Create and Update carry the full product; Update and Delete target id
+ */
+struct BulkOperation {
+    enum class Type { Create, Update, Delete };
+
+    Type type{Type::Create};
+    std::string id;
+    Product product;
+};
+
+/**
+ * BulkItemResult - Outcome of one BulkOperation, reported in request order
+ * id is the created or targeted product; error is set when the item failed
+ */
+struct BulkItemResult {
+    std::string id;
+    std::optional<utils::AppError> error;
+};
+
 /**
  * ProductRepository interface - Port (Primary)
  * This is the interface that the domain layer expects
  * Implementations are provided by the infrastructure layer (adapters)
+ *
+ * Products come back as shared immutable snapshots, null when there is
+ * no product (the error then says why); callers pass them on rather
+ * than copying.
  */
 class ProductRepository {
 public:
     virtual ~ProductRepository() = default;
 
     // Find all products with optional category filter
-    virtual std::pair<std::vector<Product>, std::optional<utils::AppError>> 
+    virtual std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>> 
         findAll(const std::string& category = "") = 0;
 
+    // Find up to limit products ordered by id, starting after afterId
+    virtual std::pair<ProductPage, std::optional<utils::AppError>>
+        findPage(const std::string& category, const std::string& afterId,
+                 std::size_t limit) = 0;
+
     // Find product by ID
-    virtual std::pair<std::optional<Product>, std::optional<utils::AppError>> 
+    virtual std::pair<ProductPtr, std::optional<utils::AppError>> 
         findById(const std::string& id) = 0;
 
+    // Find several products in one round trip. Results follow the order of
+    // ids; ids that do not exist are simply absent from the result.
+    virtual std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+        findByIds(const std::vector<std::string>& ids) = 0;
+
     // Create new product
     virtual std::pair<std::string, std::optional<utils::AppError>> 
         create(const Product& product) = 0;
 
-    // Update existing product
-    virtual std::optional<utils::AppError> 
+    // Replace an existing product's fields in one round trip and return
+    // the product as stored afterwards
+    virtual std::pair<ProductPtr, std::optional<utils::AppError>>
         update(const Product& product) = 0;
 
+    // Write only the fields set in patch, in one round trip, and return
+    // the product as stored afterwards
+    virtual std::pair<ProductPtr, std::optional<utils::AppError>>
+        patch(const std::string& id, const ProductPatch& patch) = 0;
+
+    // Take quantity units of stock in one atomic step, only if that many
+    // are available (conflict otherwise). Returns the product afterwards.
+    virtual std::pair<ProductPtr, std::optional<utils::AppError>>
+        reserveStock(const std::string& id, int quantity) = 0;
+
+    // Return quantity previously reserved units to stock
+    virtual std::pair<ProductPtr, std::optional<utils::AppError>>
+        releaseStock(const std::string& id, int quantity) = 0;
+
     // Delete product by ID
     virtual std::optional<utils::AppError> 
         deleteById(const std::string& id) = 0;
 
+    // Apply a batch of operations in one round trip where the store allows it.
+    // Items fail independently; the error is only set if the batch as a whole failed.
+    virtual std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+        bulkWrite(const std::vector<BulkOperation>& operations) = 0;
+
     // Check if product exists
     virtual bool exists(const std::string& id) = 0;
 };
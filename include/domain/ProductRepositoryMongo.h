@@ -3,41 +3,118 @@
 #include "domain/ProductRepository.h"
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/pool.hpp>
+#include <atomic>
+#include <cstdint>
 
 namespace domain {
 
+/**
+ * MongoPoolStats - Snapshot of connection pool gauges
+ * Used to size the pool under load
+ */
+struct MongoPoolStats {
+    std::size_t minSize{0};
+    std::size_t maxSize{0};
+    std::int64_t inUse{0};
+    std::uint64_t checkouts{0};
+    double totalWaitSeconds{0.0};
+    double maxWaitSeconds{0.0};
+};
+
 /**
  * ProductRepositoryMongo - Secondary Adapter
  * Implements ProductRepository interface using MongoDB
+ * Every operation checks a client out of a mongocxx::pool, so the
+ * repository can be shared by concurrent server threads
  */
 class ProductRepositoryMongo : public ProductRepository {
 public:
-    explicit ProductRepositoryMongo(const std::string& connectionString,
-                                   const std::string& databaseName);
+    ProductRepositoryMongo(const std::string& connectionString,
+                           const std::string& databaseName,
+                           std::size_t minPoolSize = 0,
+                           std::size_t maxPoolSize = 100);
 
-    std::pair<std::vector<Product>, std::optional<utils::AppError>> 
+    std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>> 
         findAll(const std::string& category = "") override;
 
-    std::pair<std::optional<Product>, std::optional<utils::AppError>> 
+    std::pair<ProductPage, std::optional<utils::AppError>>
+        findPage(const std::string& category, const std::string& afterId,
+                 std::size_t limit) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>> 
         findById(const std::string& id) override;
 
+    std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+        findByIds(const std::vector<std::string>& ids) override;
+
     std::pair<std::string, std::optional<utils::AppError>> 
         create(const Product& product) override;
 
-    std::optional<utils::AppError> 
+    std::pair<ProductPtr, std::optional<utils::AppError>>
         update(const Product& product) override;
 
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        patch(const std::string& id, const ProductPatch& patch) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        reserveStock(const std::string& id, int quantity) override;
+
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        releaseStock(const std::string& id, int quantity) override;
+
     std::optional<utils::AppError> 
         deleteById(const std::string& id) override;
 
+    std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+        bulkWrite(const std::vector<BulkOperation>& operations) override;
+
     bool exists(const std::string& id) override;
 
+    MongoPoolStats getPoolStats() const;
+
+    // BSON mapping, stateless and exposed for the microbenchmarks
+    static ProductPtr documentToProduct(const bsoncxx::document::view& doc);
+    static bsoncxx::document::value productToDocument(const Product& product);
+    static bsoncxx::document::value productToUpdate(const Product& product);
+    static bsoncxx::document::value patchToUpdate(const ProductPatch& patch);
+
 private:
-    mongocxx::client client_;
-    mongocxx::database db_;
-    
-    Product documentToProduct(const bsoncxx::document::view& doc);
-    bsoncxx::document::value productToDocument(const Product& product);
+    // RAII checkout of a pooled client that keeps the in-use gauge accurate
+    class ClientLease {
+    public:
+        ClientLease(mongocxx::pool::entry entry, std::atomic<std::int64_t>& inUse)
+            : entry_(std::move(entry)), inUse_(inUse) {}
+        ~ClientLease() { inUse_.fetch_sub(1, std::memory_order_relaxed); }
+
+        ClientLease(const ClientLease&) = delete;
+        ClientLease& operator=(const ClientLease&) = delete;
+
+        mongocxx::client& client() { return *entry_; }
+
+    private:
+        mongocxx::pool::entry entry_;
+        std::atomic<std::int64_t>& inUse_;
+    };
+
+    std::string databaseName_;
+    std::size_t minPoolSize_;
+    std::size_t maxPoolSize_;
+    mongocxx::pool pool_;
+
+    std::atomic<std::int64_t> inUse_{0};
+    std::atomic<std::uint64_t> checkouts_{0};
+    std::atomic<std::uint64_t> totalWaitNanos_{0};
+    std::atomic<std::uint64_t> maxWaitNanos_{0};
+
+    ClientLease acquire();
+    mongocxx::collection products(ClientLease& lease);
+
+    // find_one_and_update by _id returning the updated document. With
+    // minStock set, only a product holding at least that much stock matches.
+    std::pair<ProductPtr, std::optional<utils::AppError>>
+        findAndUpdate(const std::string& id, const bsoncxx::document::value& update,
+                      const char* operation, std::optional<int> minStock = std::nullopt);
 };
 
 } // namespace domain
@@ -1,35 +1,116 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <nlohmann/json.hpp>
+#include "domain/Product.h"
+#include "utils/ETag.h"
 
 namespace dto {
 
 /**
  * ProductResponse DTO
  * Data Transfer Object for sending product information to clients
+ * Refers to the repository's snapshot instead of copying its fields;
+ * they are read when the response is serialized.
  */
 struct ProductResponse {
-    std::string id;
-    std::string name;
-    std::string description;
-    double price;
-    int stock;
-    std::string category;
-    std::string status;
+    domain::ProductPtr product;
 
     // Convert to JSON
     nlohmann::json toJson() const {
         return nlohmann::json{
-            {"id", id},
-            {"name", name},
-            {"description", description},
-            {"price", price},
-            {"stock", stock},
-            {"category", category},
-            {"status", status}
+            {"id", product->getId()},
+            {"name", product->getName()},
+            {"description", product->getDescription()},
+            {"price", product->getPrice()},
+            {"stock", product->getStock()},
+            {"category", product->getCategory()},
+            {"status", product->getStatus()}
         };
     }
+
+    // Serialize straight into a buffer with any of the utils writers; the
+    // JSON output is the same as toJson().dump()
+    template <typename Writer>
+    void write(Writer& writer) const {
+        writer.beginObject(7);
+        writer.member("category", product->getCategory());
+        writer.member("description", product->getDescription());
+        writer.member("id", product->getId());
+        writer.member("name", product->getName());
+        writer.member("price", product->getPrice());
+        writer.member("status", product->getStatus());
+        writer.member("stock", product->getStock());
+        writer.endObject();
+    }
+
+    // Feeds every serialized field (status derives from stock) into an ETag
+    void hashInto(utils::ETag& etag) const {
+        etag.add(product->getId());
+        etag.add(product->getName());
+        etag.add(product->getDescription());
+        etag.add(product->getPrice());
+        etag.add(product->getStock());
+        etag.add(product->getCategory());
+    }
+};
+
+/**
+ * ProductPageResponse DTO
+ * One page of products plus the cursor for the next page (empty on the last page)
+ */
+struct ProductPageResponse {
+    std::vector<ProductResponse> items;
+    std::string nextCursor;
+
+    void hashInto(utils::ETag& etag) const {
+        for (const auto& item : items) {
+            item.hashInto(etag);
+        }
+        etag.add(nextCursor);
+    }
+};
+
+/**
+ * ProductBatchResponse DTO
+ * Result of a multi-get: the products found, in request order, and the
+ * requested ids that do not exist
+ */
+struct ProductBatchResponse {
+    std::vector<ProductResponse> items;
+    std::vector<std::string> missing;
+
+    template <typename Writer>
+    void write(Writer& writer) const {
+        writer.beginObject(2);
+        writer.key("items");
+        writer.beginArray(items.size());
+        for (const auto& item : items) {
+            item.write(writer);
+        }
+        writer.endArray();
+        writer.key("missing");
+        writer.beginArray(missing.size());
+        for (const auto& id : missing) {
+            writer.value(id);
+        }
+        writer.endArray();
+        writer.endObject();
+    }
+
+    void hashInto(utils::ETag& etag) const {
+        for (const auto& item : items) {
+            item.hashInto(etag);
+        }
+        etag.add(static_cast<std::int64_t>(missing.size()));
+        for (const auto& id : missing) {
+            etag.add(id);
+        }
+    }
 };
 
 /**
@@ -88,6 +169,226 @@ struct UpdateProductRequest {
     }
 };
 
+/**
+ * PatchProductRequest DTO
+ * Partial update: only the fields present in the body are changed
+ */
+struct PatchProductRequest {
+    std::string id;
+    std::optional<std::string> name;
+    std::optional<std::string> description;
+    std::optional<double> price;
+    std::optional<int> stock;
+    std::optional<std::string> category;
+
+    // A present field of the wrong type throws, like a malformed body
+    static PatchProductRequest fromJson(const nlohmann::json& j, const std::string& productId) {
+        PatchProductRequest req;
+        req.id = productId;
+        if (j.contains("name")) {
+            req.name = j.at("name").get<std::string>();
+        }
+        if (j.contains("description")) {
+            req.description = j.at("description").get<std::string>();
+        }
+        if (j.contains("price")) {
+            req.price = j.at("price").get<double>();
+        }
+        if (j.contains("stock")) {
+            req.stock = j.at("stock").get<int>();
+        }
+        if (j.contains("category")) {
+            req.category = j.at("category").get<std::string>();
+        }
+        return req;
+    }
+
+    bool hasChanges() const {
+        return name || description || price || stock || category;
+    }
+
+    // Present fields follow the same rules as a full update
+    bool isValid() const {
+        return !id.empty() && (!name || !name->empty()) && (!price || *price >= 0) &&
+               (!stock || *stock >= 0) && (!category || !category->empty());
+    }
+};
+
+/**
+ * BulkOperationRequest DTO
+ * One item of a bulk write: op is "create", "update" or "delete".
+ * Create and update carry the product fields; update and delete target id.
+ */
+struct BulkOperationRequest {
+    std::string op;
+    std::string id;
+    CreateProductRequest product;
+
+    static BulkOperationRequest fromJson(const nlohmann::json& j) {
+        BulkOperationRequest req;
+        req.op = j.value("op", "");
+        req.id = j.value("id", "");
+        if (j.contains("product")) {
+            req.product = CreateProductRequest::fromJson(j.at("product"));
+        }
+        return req;
+    }
+};
+
+/**
+ * BulkWriteRequest DTO
+ * Body of POST /products/_bulk. An item that cannot be parsed is kept
+ * with an empty op, so it fails on its own instead of failing the batch.
+ */
+struct BulkWriteRequest {
+    std::vector<BulkOperationRequest> operations;
+
+    static BulkWriteRequest fromJson(const nlohmann::json& j) {
+        BulkWriteRequest req;
+        const auto& operations = j.at("operations");
+        if (!operations.is_array()) {
+            throw std::invalid_argument("operations must be an array");
+        }
+        req.operations.reserve(operations.size());
+        for (const auto& item : operations) {
+            try {
+                req.operations.push_back(BulkOperationRequest::fromJson(item));
+            } catch (const nlohmann::json::exception&) {
+                req.operations.emplace_back();
+            }
+        }
+        return req;
+    }
+};
+
+/**
+ * BulkItemResponse DTO
+ * Outcome of one bulk item; message is only written for failed items
+ */
+struct BulkItemResponse {
+    std::size_t index{0};
+    int status{0};
+    std::string id;
+    std::string message;
+
+    template <typename Writer>
+    void write(Writer& writer) const {
+        writer.beginObject(2 + !id.empty() + !message.empty());
+        if (!id.empty()) {
+            writer.member("id", id);
+        }
+        writer.member("index", static_cast<std::uint64_t>(index));
+        if (!message.empty()) {
+            writer.member("message", message);
+        }
+        writer.member("status", status);
+        writer.endObject();
+    }
+};
+
+/**
+ * BulkWriteResponse DTO
+ * Per-item results in request order plus success/failure counts
+ */
+struct BulkWriteResponse {
+    std::vector<BulkItemResponse> results;
+    std::size_t succeeded{0};
+    std::size_t failed{0};
+
+    template <typename Writer>
+    void write(Writer& writer) const {
+        writer.beginObject(3);
+        writer.member("failed", static_cast<std::uint64_t>(failed));
+        writer.key("results");
+        writer.beginArray(results.size());
+        for (const auto& result : results) {
+            result.write(writer);
+        }
+        writer.endArray();
+        writer.member("succeeded", static_cast<std::uint64_t>(succeeded));
+        writer.endObject();
+    }
+};
+
+/**
+ * StockChangeRequest DTO
+ * Body of POST /products/{id}/reserve and /release
+ */
+struct StockChangeRequest {
+    std::string id;
+    int quantity{0};
+
+    static StockChangeRequest fromJson(const nlohmann::json& j, const std::string& productId) {
+        StockChangeRequest req;
+        req.id = productId;
+        req.quantity = j.at("quantity").get<int>();
+        return req;
+    }
+
+    bool isValid() const {
+        return !id.empty() && quantity > 0;
+    }
+};
+
+/**
+ * StockBatchRequest DTO
+ * Body of POST /products/_reserve and /_release: the lines of one order.
+ * The batch is all or nothing, so a malformed item fails it as a whole.
+ */
+struct StockBatchRequest {
+    std::vector<StockChangeRequest> items;
+
+    static StockBatchRequest fromJson(const nlohmann::json& j) {
+        StockBatchRequest req;
+        const auto& items = j.at("items");
+        if (!items.is_array()) {
+            throw std::invalid_argument("items must be an array");
+        }
+        req.items.reserve(items.size());
+        for (const auto& item : items) {
+            req.items.push_back(StockChangeRequest::fromJson(item, item.at("id").get<std::string>()));
+        }
+        return req;
+    }
+};
+
+/**
+ * StockLevelResponse DTO
+ * Stock of one product right after a reservation or release
+ */
+struct StockLevelResponse {
+    std::string id;
+    int stock{0};
+
+    template <typename Writer>
+    void write(Writer& writer) const {
+        writer.beginObject(2);
+        writer.member("id", id);
+        writer.member("stock", stock);
+        writer.endObject();
+    }
+};
+
+/**
+ * StockBatchResponse DTO
+ * Stock levels after a batch, in request order
+ */
+struct StockBatchResponse {
+    std::vector<StockLevelResponse> items;
+
+    template <typename Writer>
+    void write(Writer& writer) const {
+        writer.beginObject(1);
+        writer.key("items");
+        writer.beginArray(items.size());
+        for (const auto& item : items) {
+            item.write(writer);
+        }
+        writer.endArray();
+        writer.endObject();
+    }
+};
+
 /**
  * ErrorResponse DTO
  * Data Transfer Object for error responses
@@ -102,6 +403,14 @@ struct ErrorResponse {
             {"message", message}
         };
     }
+
+    template <typename Writer>
+    void write(Writer& writer) const {
+        writer.beginObject(2);
+        writer.member("code", code);
+        writer.member("message", message);
+        writer.endObject();
+    }
 };
 
 } // namespace dto
@@ -15,14 +15,21 @@ class ProductService {
 public:
     explicit ProductService(std::shared_ptr<domain::ProductRepository> repository);
 
-    // Get all products with optional category filter
-    std::pair<std::vector<dto::ProductResponse>, std::optional<utils::AppError>>
-        getAllProducts(const std::string& category = "");
+    // Get one page of products, ordered by id, with optional category filter
+    std::pair<dto::ProductPageResponse, std::optional<utils::AppError>>
+        getProductPage(const std::string& category, const std::string& afterId,
+                       std::size_t limit);
 
     // Get product by ID
     std::pair<std::optional<dto::ProductResponse>, std::optional<utils::AppError>>
         getProduct(const std::string& id);
 
+    // Get several products by ID in one repository call; unknown ids are listed as missing.
+    // ids must be distinct and in canonical form (utils::ObjectId::normalize), as the
+    // repositories return them; ProductHandler normalizes them while parsing ?ids=.
+    std::pair<dto::ProductBatchResponse, std::optional<utils::AppError>>
+        getProductsByIds(const std::vector<std::string>& ids);
+
     // Create new product
     std::pair<dto::ProductResponse, std::optional<utils::AppError>>
         createProduct(const dto::CreateProductRequest& request);
@@ -31,14 +38,51 @@ public:
     std::pair<dto::ProductResponse, std::optional<utils::AppError>>
         updateProduct(const dto::UpdateProductRequest& request);
 
+    // Update only the fields present in the request
+    std::pair<dto::ProductResponse, std::optional<utils::AppError>>
+        patchProduct(const dto::PatchProductRequest& request);
+
+    // Take stock for an order atomically; 409 when not enough is left
+    std::pair<dto::StockLevelResponse, std::optional<utils::AppError>>
+        reserveStock(const dto::StockChangeRequest& request);
+
+    // Give reserved stock back
+    std::pair<dto::StockLevelResponse, std::optional<utils::AppError>>
+        releaseStock(const dto::StockChangeRequest& request);
+
+    // Reserve every line of an order, or none of them
+    std::pair<dto::StockBatchResponse, std::optional<utils::AppError>>
+        reserveStockBatch(const dto::StockBatchRequest& request);
+
+    // Release every line of an order, or none of them
+    std::pair<dto::StockBatchResponse, std::optional<utils::AppError>>
+        releaseStockBatch(const dto::StockBatchRequest& request);
+
     // Delete product
     std::optional<utils::AppError>
         deleteProduct(const std::string& id);
 
+    // Apply a batch of creates, updates and deletes; items succeed or fail independently
+    std::pair<dto::BulkWriteResponse, std::optional<utils::AppError>>
+        bulkWrite(const dto::BulkWriteRequest& request);
+
+    // Wraps the snapshot; no field is copied
+    static dto::ProductResponse productToDto(domain::ProductPtr product);
+
 private:
+    using StockChange = std::pair<domain::ProductPtr, std::optional<utils::AppError>>
+        (domain::ProductRepository::*)(const std::string&, int);
+
     std::shared_ptr<domain::ProductRepository> repository_;
-    
-    dto::ProductResponse productToDto(const domain::Product& product);
+
+    std::pair<dto::StockLevelResponse, std::optional<utils::AppError>>
+        changeStock(const dto::StockChangeRequest& request, StockChange change);
+
+    // Applies change to each item in order; on the first failure, undo
+    // reverts the items already applied
+    std::pair<dto::StockBatchResponse, std::optional<utils::AppError>>
+        changeStockBatch(const dto::StockBatchRequest& request, StockChange change,
+                         StockChange undo);
 };
 
 } // namespace service
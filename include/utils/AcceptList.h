@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <string_view>
+
+namespace utils {
+
+/**
+ * AcceptList - Items of an Accept or Accept-Encoding header
+ * next() yields each media range or coding with its q-value (1 when
+ * absent) in header order, without allocating; other parameters are
+ * skipped.
+ */
+class AcceptList {
+public:
+    explicit AcceptList(std::string_view header) : rest_(header) {}
+
+    // False once every item has been returned
+    bool next(std::string_view& token, double& quality) {
+        while (!rest_.empty()) {
+            auto comma = rest_.find(',');
+            auto item = rest_.substr(0, comma);
+            rest_ = comma == std::string_view::npos ? std::string_view{} : rest_.substr(comma + 1);
+
+            auto semicolon = item.find(';');
+            token = trim(item.substr(0, semicolon));
+            if (token.empty()) {
+                continue;
+            }
+
+            quality = 1.0;
+            while (semicolon != std::string_view::npos) {
+                item = item.substr(semicolon + 1);
+                semicolon = item.find(';');
+                auto parameter = trim(item.substr(0, semicolon));
+                if (parameter.size() > 2 && (parameter[0] | 0x20) == 'q' && parameter[1] == '=') {
+                    quality = parseQuality(parameter.substr(2));
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+    static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        return a.size() == b.size() &&
+               std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                   return (x | 0x20) == (y | 0x20);
+               });
+    }
+
+    static std::string_view trim(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+        return value;
+    }
+
+private:
+    std::string_view rest_;
+
+    // qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] )
+    static double parseQuality(std::string_view value) {
+        if (value.empty() || (value[0] != '0' && value[0] != '1')) {
+            return 0.0;
+        }
+        double quality = value[0] - '0';
+        double scale = 0.1;
+        for (std::size_t i = 2; i < value.size() && i < 5 && value[1] == '.'; ++i) {
+            if (value[i] < '0' || value[i] > '9') {
+                break;
+            }
+            quality += (value[i] - '0') * scale;
+            scale /= 10;
+        }
+        return std::min(quality, 1.0);
+    }
+};
+
+} // namespace utils
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace utils {
+
+/**
+ * MsgPackWriter - Streaming MessagePack serializer
+ * Same interface as JsonWriter. Maps and arrays are length-prefixed, so
+ * beginObject() and beginArray() must be given the exact count. Numbers
+ * take their smallest encoding, doubles included (float 32 when exact),
+ * which matches nlohmann::json::to_msgpack(). Strings are written as
+ * they are and must already be valid UTF-8.
+ */
+class MsgPackWriter {
+public:
+    explicit MsgPackWriter(std::string& out) : out_(out) {}
+
+    void beginObject(std::size_t members);
+    void endObject() {}
+    void beginArray(std::size_t elements);
+    void endArray() {}
+
+    void key(std::string_view name) { value(name); }
+
+    void value(std::string_view text);
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(const std::string& text) { value(std::string_view(text)); }
+    void value(double number);
+    void value(int number) { value(static_cast<std::int64_t>(number)); }
+    void value(std::int64_t number);
+    void value(std::uint64_t number);
+    void value(bool flag);
+    void null();
+
+    template <typename T>
+    void member(std::string_view name, const T& v) {
+        key(name);
+        value(v);
+    }
+
+private:
+    std::string& out_;
+};
+
+/**
+ * CborWriter - Streaming CBOR (RFC 8949) serializer
+ * Same interface and contract as MsgPackWriter; containers use definite
+ * lengths and the output matches nlohmann::json::to_cbor().
+ */
+class CborWriter {
+public:
+    explicit CborWriter(std::string& out) : out_(out) {}
+
+    void beginObject(std::size_t members);
+    void endObject() {}
+    void beginArray(std::size_t elements);
+    void endArray() {}
+
+    void key(std::string_view name) { value(name); }
+
+    void value(std::string_view text);
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(const std::string& text) { value(std::string_view(text)); }
+    void value(double number);
+    void value(int number) { value(static_cast<std::int64_t>(number)); }
+    void value(std::int64_t number);
+    void value(std::uint64_t number);
+    void value(bool flag);
+    void null();
+
+    template <typename T>
+    void member(std::string_view name, const T& v) {
+        key(name);
+        value(v);
+    }
+
+private:
+    std::string& out_;
+
+    // Major type and argument, in the shortest form
+    void head(std::uint8_t major, std::uint64_t argument);
+};
+
+} // namespace utils
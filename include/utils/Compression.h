@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+struct z_stream_s;
+
+namespace utils {
+
+/**
+ * ContentEncoding - Response body encodings the service can produce
+ */
+enum class ContentEncoding {
+    Identity,
+    Gzip,
+    // zlib format (RFC 1950), which is what HTTP calls "deflate"
+    Deflate
+};
+
+// Content-Encoding token, e.g. "gzip"
+std::string_view contentEncodingName(ContentEncoding encoding);
+
+// Best encoding allowed by an Accept-Encoding header. q-values are
+// honoured and gzip wins ties; Identity when nothing usable is accepted.
+ContentEncoding negotiateEncoding(std::string_view acceptEncoding);
+
+/**
+ * CompressionOptions - Response compression negotiated via Accept-Encoding
+ */
+struct CompressionOptions {
+    bool enabled{true};
+    // zlib level, 1 (fastest) to 9 (smallest)
+    int level{6};
+    // Bodies smaller than this are sent as they are
+    std::size_t minSize{1024};
+};
+
+/**
+ * Compressor - Streaming zlib encoder for gzip and deflate bodies
+ * Input may arrive in pieces. write() appends whatever output zlib has
+ * ready, flush() forces out everything written so far (call it at the
+ * end of each chunk of a chunked response so the client can decode it
+ * on arrival) and finish() ends the stream.
+ */
+class Compressor {
+public:
+    // level 1 (fastest) to 9 (smallest); out of range values are clamped
+    Compressor(ContentEncoding encoding, int level);
+    ~Compressor();
+
+    Compressor(const Compressor&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+
+    void write(std::string_view input, std::string& out);
+    void flush(std::string& out);
+    void finish(std::string& out);
+
+    // Whole body in one call
+    static std::string compress(ContentEncoding encoding, int level, std::string_view input);
+
+private:
+    std::unique_ptr<z_stream_s> stream_;
+
+    void deflateInto(std::string_view input, int mode, std::string& out);
+};
+
+} // namespace utils
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace utils {
+
+/**
+ * ETag - Strong entity tag built from a 64-bit FNV-1a hash
+ * Response fields are fed in directly, so the tag is known before the
+ * body is serialized and a 304 can skip serialization entirely.
+ */
+class ETag {
+public:
+    void add(std::string_view value) {
+        for (unsigned char c : value) {
+            mix(c);
+        }
+        // Separator, so ("ab", "c") and ("a", "bc") hash differently
+        mix(0xFF);
+    }
+
+    void add(double value) {
+        unsigned char bytes[sizeof(double)];
+        std::memcpy(bytes, &value, sizeof(bytes));
+        for (auto b : bytes) {
+            mix(b);
+        }
+    }
+
+    void add(std::int64_t value) {
+        for (std::size_t i = 0; i < sizeof(value); ++i) {
+            mix(static_cast<unsigned char>(static_cast<std::uint64_t>(value) >> (i * 8)));
+        }
+    }
+
+    void add(int value) { add(static_cast<std::int64_t>(value)); }
+
+    // Quoted header value, e.g. "9f86d081884c7d65"
+    std::string str() const {
+        static constexpr char kDigits[] = "0123456789abcdef";
+        std::string tag(18, '"');
+        for (std::size_t i = 0; i < 16; ++i) {
+            tag[16 - i] = kDigits[(hash_ >> (i * 4)) & 0xF];
+        }
+        return tag;
+    }
+
+    // If-None-Match uses the weak comparison: W/ prefixes are ignored and
+    // "*" matches any current representation
+    static bool matches(std::string_view ifNoneMatch, std::string_view etag) {
+        std::size_t pos = 0;
+        while (pos < ifNoneMatch.size()) {
+            auto end = ifNoneMatch.find(',', pos);
+            if (end == std::string_view::npos) {
+                end = ifNoneMatch.size();
+            }
+            auto candidate = trim(ifNoneMatch.substr(pos, end - pos));
+            if (candidate == "*") {
+                return true;
+            }
+            if (candidate.substr(0, 2) == "W/") {
+                candidate.remove_prefix(2);
+            }
+            if (candidate == etag) {
+                return true;
+            }
+            pos = end + 1;
+        }
+        return false;
+    }
+
+private:
+    std::uint64_t hash_{14695981039346656037ull};
+
+    void mix(unsigned char byte) {
+        hash_ ^= byte;
+        hash_ *= 1099511628211ull;
+    }
+
+    static std::string_view trim(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+        return value;
+    }
+};
+
+} // namespace utils
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace utils {
+
+/**
+ * JsonWriter - Streaming JSON serializer
+ * Appends JSON text straight into a caller-owned buffer (typically a
+ * response body) without building an intermediate document tree.
+ * Commas and key/value separators are inserted automatically. Shares
+ * its interface with MsgPackWriter and CborWriter, so a DTO's write()
+ * template serves every format.
+ */
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    // Counts are for the length-prefixed formats; JSON does not need them
+    void beginObject(std::size_t members = 0);
+    void endObject();
+    void beginArray(std::size_t elements = 0);
+    void endArray();
+
+    void key(std::string_view name);
+
+    void value(std::string_view text);
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(const std::string& text) { value(std::string_view(text)); }
+    void value(double number);
+    void value(int number) { value(static_cast<std::int64_t>(number)); }
+    void value(std::int64_t number);
+    void value(std::uint64_t number);
+    void value(bool flag);
+    void null();
+
+    // Convenience for "name": value members
+    template <typename T>
+    void member(std::string_view name, const T& v) {
+        key(name);
+        value(v);
+    }
+
+private:
+    std::string& out_;
+    bool needComma_{false};
+    bool afterKey_{false};
+
+    void prefix();
+    void writeString(std::string_view text);
+};
+
+} // namespace utils
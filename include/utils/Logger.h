@@ -1,22 +1,72 @@
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <spdlog/spdlog.h>
 
 namespace utils {
 
+/**
+ * LoggerOptions - Sink mode, level and access-log sampling
+ */
+struct LoggerOptions {
+    // trace, debug, info, warn, error, critical or off
+    std::string level{"info"};
+    // Hand records to a background thread through a bounded queue
+    bool async{false};
+    std::size_t queueSize{8192};
+    // When the queue is full: "block" waits, "drop" overwrites the oldest record
+    std::string overflowPolicy{"block"};
+    // Fraction of requests written to the access log (0 disables, 1 logs all);
+    // server errors are always logged
+    double accessLogSampleRate{1.0};
+};
+
 /**
  * Logger utility class
- * Wrapper around spdlog for logging
+ * Wrapper around spdlog for logging. Messages take fmt-style format
+ * arguments, which are only formatted when the level is enabled.
  */
 class Logger {
 public:
-    static void init();
-    
-    static void info(const std::string& message);
-    static void error(const std::string& message);
-    static void warn(const std::string& message);
-    static void debug(const std::string& message);
+    static void init(const LoggerOptions& options = {});
+
+    // Flush and stop the background thread in async mode
+    static void shutdown();
+
+    template <typename... Args>
+    static void info(spdlog::format_string_t<Args...> format, Args&&... args) {
+        spdlog::info(format, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    static void error(spdlog::format_string_t<Args...> format, Args&&... args) {
+        spdlog::error(format, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    static void warn(spdlog::format_string_t<Args...> format, Args&&... args) {
+        spdlog::warn(format, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    static void debug(spdlog::format_string_t<Args...> format, Args&&... args) {
+        spdlog::debug(format, std::forward<Args>(args)...);
+    }
+
+    // Whether the request that produced this status goes to the access log
+    static bool sampleAccess(unsigned status);
+
+    // One structured line per request; call only when sampleAccess() agreed
+    static void access(std::string_view method, std::string_view target, unsigned status,
+                       std::size_t bytes, std::chrono::microseconds duration);
+
+private:
+    static std::shared_ptr<spdlog::logger> accessLogger_;
+    static std::uint32_t accessSamplePeriod_;
 };
 
 } // namespace utils
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utils {
+
+/**
+ * Metric - A single time series in the Prometheus text format
+ */
+class Metric {
+public:
+    virtual ~Metric() = default;
+
+    // Appends the sample lines for this series
+    virtual void render(std::string& out, const std::string& name,
+                        const std::string& labels) const = 0;
+};
+
+/**
+ * Counter - Monotonically increasing value
+ */
+class Counter : public Metric {
+public:
+    void inc(std::uint64_t amount = 1) { value_.fetch_add(amount, std::memory_order_relaxed); }
+    std::uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    void render(std::string& out, const std::string& name,
+                const std::string& labels) const override;
+
+private:
+    std::atomic<std::uint64_t> value_{0};
+};
+
+/**
+ * Gauge - Value that can go up and down
+ */
+class Gauge : public Metric {
+public:
+    void inc(std::int64_t amount = 1) { value_.fetch_add(amount, std::memory_order_relaxed); }
+    void dec(std::int64_t amount = 1) { value_.fetch_sub(amount, std::memory_order_relaxed); }
+    void set(std::int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    std::int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    void render(std::string& out, const std::string& name,
+                const std::string& labels) const override;
+
+private:
+    std::atomic<std::int64_t> value_{0};
+};
+
+/**
+ * Histogram - Latency distribution over fixed buckets (100 us to 10 s)
+ * Observations land in one of several cache-line aligned stripes chosen
+ * per thread, so concurrent writers rarely share a line. Stripes are
+ * only summed when the histogram is rendered.
+ */
+class Histogram : public Metric {
+public:
+    static constexpr std::array<std::uint64_t, 16> kBoundsMicros{
+        100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+        100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000};
+
+    void observe(std::chrono::nanoseconds duration);
+
+    std::uint64_t count() const;
+
+    void render(std::string& out, const std::string& name,
+                const std::string& labels) const override;
+
+private:
+    static constexpr std::size_t kStripes = 8;
+
+    struct alignas(64) Stripe {
+        // One slot per bound plus the +Inf bucket; counts are not cumulative
+        std::array<std::atomic<std::uint64_t>, kBoundsMicros.size() + 1> buckets{};
+        std::atomic<std::uint64_t> sumNanos{0};
+    };
+
+    std::array<Stripe, kStripes> stripes_;
+};
+
+/**
+ * MetricsWriter - Appends samples computed at scrape time
+ * Used by collectors to export values that already live elsewhere,
+ * such as pool and cache statistics.
+ */
+class MetricsWriter {
+public:
+    explicit MetricsWriter(std::string& out) : out_(out) {}
+
+    void counter(std::string_view name, std::string_view help, double value,
+                 std::string_view labels = {});
+    void gauge(std::string_view name, std::string_view help, double value,
+               std::string_view labels = {});
+
+private:
+    std::string& out_;
+    std::string lastFamily_;
+
+    void sample(std::string_view name, std::string_view help, std::string_view type,
+                double value, std::string_view labels);
+};
+
+/**
+ * MetricsRegistry - Process-wide set of metrics, rendered for /metrics
+ * Lookups take a mutex, so callers resolve their series once and keep
+ * the returned reference; recording on it is lock-free. Series live as
+ * long as the process.
+ */
+class MetricsRegistry {
+public:
+    using Collector = std::function<void(MetricsWriter&)>;
+
+    static MetricsRegistry& global();
+
+    // labels is the preformatted label set, e.g. method="GET",status="200"
+    Counter& counter(const std::string& name, const std::string& help,
+                     const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help,
+                 const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         const std::string& labels = "");
+
+    void addCollector(Collector collector);
+
+    // Prometheus text exposition format, version 0.0.4
+    std::string render() const;
+
+    // Escapes a label value for use inside double quotes
+    static std::string escapeLabel(std::string_view value);
+
+private:
+    struct Family {
+        std::string help;
+        std::string type;
+        std::map<std::string, std::unique_ptr<Metric>> series;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+    std::vector<Collector> collectors_;
+
+    template <typename T>
+    T& series(const std::string& name, const std::string& help, const char* type,
+              const std::string& labels);
+};
+
+} // namespace utils
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace utils {
+
+/**
+ * ObjectId helpers
+ * MongoDB ObjectIds travel through the API as 24 hexadecimal characters
+ */
+class ObjectId {
+public:
+    static constexpr std::size_t kHexLength = 24;
+
+    static bool isValid(std::string_view value) {
+        if (value.size() != kHexLength) {
+            return false;
+        }
+        for (char c : value) {
+            bool hex = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+            if (!hex) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Canonical (lowercase) form of a valid id, as the driver prints it
+    static std::string normalize(std::string_view value) {
+        std::string id(value);
+        for (auto& c : id) {
+            if (c >= 'A' && c <= 'F') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        return id;
+    }
+
+    // New id laid out like the driver's: 4-byte seconds, 5-byte
+    // per-process random value, 3-byte counter. Ids from one process
+    // sort in creation order, as _id does.
+    static std::string generate() {
+        static const std::uint64_t processUnique = [] {
+            std::random_device device;
+            return ((static_cast<std::uint64_t>(device()) << 32) | device()) & 0xFFFFFFFFFFull;
+        }();
+        static std::atomic<std::uint32_t> counter{std::random_device{}()};
+
+        auto seconds = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        auto count = counter.fetch_add(1, std::memory_order_relaxed) & 0xFFFFFFu;
+
+        std::string id(kHexLength, '0');
+        writeHex(id, 0, seconds, 8);
+        writeHex(id, 8, processUnique, 10);
+        writeHex(id, 18, count, 6);
+        return id;
+    }
+
+private:
+    static void writeHex(std::string& out, std::size_t offset, std::uint64_t value,
+                         std::size_t digits) {
+        static constexpr char kDigits[] = "0123456789abcdef";
+        for (std::size_t i = 0; i < digits; ++i) {
+            out[offset + digits - 1 - i] = kDigits[value & 0xF];
+            value >>= 4;
+        }
+    }
+};
+
+} // namespace utils
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "utils/BinaryWriter.h"
+#include "utils/JsonWriter.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+
+namespace utils {
+
+/**
+ * MediaType - Body formats the service reads and writes
+ */
+enum class MediaType {
+    Json,
+    MessagePack,
+    Cbor
+};
+
+// Content-Type value, e.g. "application/msgpack"
+std::string_view mediaTypeName(MediaType type);
+
+// Best response format allowed by an Accept header. q-values are
+// honoured, named types beat wildcards and the first listed wins other
+// ties; JSON when the header is missing or names nothing the service writes.
+MediaType negotiateMediaType(std::string_view accept);
+
+// Format of a request body from its Content-Type; JSON when the header
+// is missing or names something else
+MediaType bodyMediaType(std::string_view contentType);
+
+// Decodes a request body for the DTO parsers; throws on a malformed body.
+// Binary bodies are held to the rule JSON text already enforces: every
+// string must be valid UTF-8.
+nlohmann::json parseBody(MediaType type, std::string_view body);
+
+// Encodes a document built as nlohmann::json, for small ad hoc bodies
+std::string dumpBody(MediaType type, const nlohmann::json& document);
+
+// Runs write(writer) with the writer for type, appending to out. write is
+// usually a generic lambda over a DTO's write() template, so every format
+// goes through the same serialization code.
+template <typename Write>
+void serialize(MediaType type, std::string& out, Write&& write) {
+    switch (type) {
+        case MediaType::MessagePack: {
+            MsgPackWriter writer(out);
+            write(writer);
+            return;
+        }
+        case MediaType::Cbor: {
+            CborWriter writer(out);
+            write(writer);
+            return;
+        }
+        case MediaType::Json:
+            break;
+    }
+    JsonWriter writer(out);
+    write(writer);
+}
+
+} // namespace utils
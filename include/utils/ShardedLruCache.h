@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace utils {
+
+/**
+ * CacheStats - Snapshot of cache counters
+ */
+struct CacheStats {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t evictions{0};
+    std::uint64_t expirations{0};
+    std::size_t size{0};
+};
+
+/**
+ * ShardedLruCache - Bounded, thread-safe LRU cache with per-entry TTL
+ * Keys are spread over independently locked shards so concurrent
+ * lookups rarely contend. Each shard evicts its least recently used
+ * entry once it holds capacity / shards entries.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedLruCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ShardedLruCache(std::size_t capacity, std::size_t shardCount)
+        : shards_(shardCount > 0 ? shardCount : 1) {
+        std::size_t perShard = (capacity + shards_.size() - 1) / shards_.size();
+        for (auto& shard : shards_) {
+            shard.capacity = perShard > 0 ? perShard : 1;
+        }
+    }
+
+    // Returns the cached value and marks it most recently used
+    std::optional<Value> get(const Key& key) {
+        auto& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        if (it->second->expiresAt <= Clock::now()) {
+            shard.entries.erase(it->second);
+            shard.index.erase(it);
+            expirations_.fetch_add(1, std::memory_order_relaxed);
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second->value;
+    }
+
+    // Returns the cached value without touching recency or counters
+    std::optional<Value> peek(const Key& key) const {
+        auto& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it == shard.index.end() || it->second->expiresAt <= Clock::now()) {
+            return std::nullopt;
+        }
+        return it->second->value;
+    }
+
+    void put(const Key& key, Value value, Clock::duration ttl) {
+        auto& shard = shardFor(key);
+        auto expiresAt = Clock::now() + ttl;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            it->second->value = std::move(value);
+            it->second->expiresAt = expiresAt;
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            return;
+        }
+
+        shard.entries.push_front(Entry{key, std::move(value), expiresAt});
+        shard.index.emplace(key, shard.entries.begin());
+
+        while (shard.entries.size() > shard.capacity) {
+            shard.index.erase(shard.entries.back().key);
+            shard.entries.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void erase(const Key& key) {
+        auto& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            shard.entries.erase(it->second);
+            shard.index.erase(it);
+        }
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.entries.clear();
+            shard.index.clear();
+        }
+    }
+
+    CacheStats stats() const {
+        CacheStats stats;
+        stats.hits = hits_.load(std::memory_order_relaxed);
+        stats.misses = misses_.load(std::memory_order_relaxed);
+        stats.evictions = evictions_.load(std::memory_order_relaxed);
+        stats.expirations = expirations_.load(std::memory_order_relaxed);
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.size += shard.entries.size();
+        }
+        return stats;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        Clock::time_point expiresAt;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries;
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+        std::size_t capacity{1};
+    };
+
+    std::vector<Shard> shards_;
+    Hash hash_;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+    std::atomic<std::uint64_t> expirations_{0};
+
+    Shard& shardFor(const Key& key) {
+        return shards_[hash_(key) % shards_.size()];
+    }
+
+    const Shard& shardFor(const Key& key) const {
+        return shards_[hash_(key) % shards_.size()];
+    }
+};
+
+} // namespace utils
@@ -42,7 +42,7 @@ db.products.insertMany([
     }
 ]);
 
-// Create index on category for better query performance
-db.products.createIndex({ category: 1 });
+// Index for category filters and keyset pagination within a category
+db.products.createIndex({ category: 1, _id: 1 });
 
 print("Database initialized with sample products!");
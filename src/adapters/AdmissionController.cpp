@@ -0,0 +1,165 @@
+#include "adapters/AdmissionController.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace adapters {
+
+namespace {
+
+// Ceiling of the adaptive limit when no maxInFlight is configured
+constexpr std::size_t kAdaptiveCeiling = 1024;
+
+std::int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+AdmissionController::AdmissionController(AdmissionOptions options,
+                                         utils::MetricsRegistry& registry)
+    : options_(std::move(options)),
+      registry_(registry),
+      limitGauge_(registry.gauge("http_admission_limit",
+                                 "Requests handled at once before new ones are shed (0: unlimited)")) {
+    if (options_.adaptive && options_.maxInFlight == 0) {
+        options_.maxInFlight = kAdaptiveCeiling;
+    }
+    options_.minLimit = std::clamp<std::size_t>(options_.minLimit, 1,
+                                                std::max<std::size_t>(options_.maxInFlight, 1));
+    limit_.store(static_cast<double>(options_.maxInFlight), std::memory_order_relaxed);
+    limitGauge_.set(static_cast<std::int64_t>(options_.maxInFlight));
+}
+
+void AdmissionController::addRoute(const std::string& method, const std::string& pattern,
+                                   bool exempt) {
+    auto state = std::make_unique<RouteState>();
+    state->exempt = exempt;
+
+    auto it = options_.routeLimits.find(method + " " + pattern);
+    state->limit = options_.maxInFlightPerRoute;
+    if (it != options_.routeLimits.end() && !exempt) {
+        state->limit = it->second;
+        utils::Logger::info("Admission limit for {} {}: {}", method, pattern, state->limit);
+    }
+
+    auto labels = "method=\"" + method + "\",route=\"" +
+                  utils::MetricsRegistry::escapeLabel(pattern) + "\"";
+    state->shedGlobal = &registry_.counter("http_requests_shed_total",
+        "Requests rejected with 503 by admission control", labels + ",limit=\"global\"");
+    state->shedRoute = &registry_.counter("http_requests_shed_total",
+        "Requests rejected with 503 by admission control", labels + ",limit=\"route\"");
+    routes_.push_back(std::move(state));
+}
+
+bool AdmissionController::tryAcquire(std::size_t route) {
+    auto& state = *routes_[route];
+    if (state.exempt) {
+        return true;
+    }
+
+    auto limit = currentLimit();
+    if (inFlight_.fetch_add(1, std::memory_order_acq_rel) >= limit && limit > 0) {
+        inFlight_.fetch_sub(1, std::memory_order_acq_rel);
+        state.shedGlobal->inc();
+        shed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (state.inFlight.fetch_add(1, std::memory_order_acq_rel) >= state.limit && state.limit > 0) {
+        state.inFlight.fetch_sub(1, std::memory_order_acq_rel);
+        inFlight_.fetch_sub(1, std::memory_order_acq_rel);
+        state.shedRoute->inc();
+        shed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void AdmissionController::release(std::size_t route) {
+    auto& state = *routes_[route];
+    if (state.exempt) {
+        return;
+    }
+    state.inFlight.fetch_sub(1, std::memory_order_acq_rel);
+    inFlight_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void AdmissionController::observeLatency(std::chrono::steady_clock::duration latency) {
+    if (!options_.adaptive) {
+        return;
+    }
+
+    auto ceiling = static_cast<double>(options_.maxInFlight);
+    auto floor = static_cast<double>(options_.minLimit);
+    auto current = limit_.load(std::memory_order_relaxed);
+    double next = current;
+
+    if (latency > options_.latencyTarget) {
+        // Calls that were already slow together are one congestion signal,
+        // not one each: back off at most once per target interval
+        auto now = nowNanos();
+        auto last = lastDecreaseNanos_.load(std::memory_order_relaxed);
+        auto interval = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            options_.latencyTarget).count();
+        if (now - last < interval ||
+            !lastDecreaseNanos_.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            return;
+        }
+        do {
+            next = std::max(floor, current * options_.backoff);
+        } while (!limit_.compare_exchange_weak(current, next, std::memory_order_relaxed));
+    } else {
+        do {
+            next = std::min(ceiling, current + 1.0 / current);
+        } while (!limit_.compare_exchange_weak(current, next, std::memory_order_relaxed));
+    }
+
+    if (static_cast<std::int64_t>(next) != static_cast<std::int64_t>(current)) {
+        limitGauge_.set(static_cast<std::int64_t>(next));
+    }
+}
+
+AdmissionStats AdmissionController::stats() const {
+    AdmissionStats stats;
+    stats.inFlight = inFlight_.load(std::memory_order_relaxed);
+    stats.limit = currentLimit();
+    stats.shed = shed_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::map<std::string, std::size_t> AdmissionController::parseRouteLimits(std::string_view spec) {
+    std::map<std::string, std::size_t> limits;
+    while (!spec.empty()) {
+        auto comma = spec.find(',');
+        auto entry = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view{} : spec.substr(comma + 1);
+
+        while (!entry.empty() && entry.front() == ' ') {
+            entry.remove_prefix(1);
+        }
+        if (entry.empty()) {
+            continue;
+        }
+
+        auto equals = entry.rfind('=');
+        auto route = entry.substr(0, equals);
+        if (equals == std::string_view::npos || route.find(' ') == std::string_view::npos) {
+            throw std::invalid_argument("Invalid route limit: " + std::string(entry));
+        }
+        // stoul would wrap a negative limit around to a huge one
+        auto limit = std::stol(std::string(entry.substr(equals + 1)));
+        if (limit < 0) {
+            throw std::invalid_argument("Invalid route limit: " + std::string(entry));
+        }
+        limits[std::string(route)] = static_cast<std::size_t>(limit);
+    }
+    return limits;
+}
+
+std::size_t AdmissionController::currentLimit() const {
+    return static_cast<std::size_t>(limit_.load(std::memory_order_relaxed));
+}
+
+} // namespace adapters
@@ -1,11 +1,22 @@
 #include "adapters/HttpServer.h"
 #include "adapters/ProductHandler.h"
+#include "dto/ProductResponse.h"
+#include "utils/Compression.h"
 #include "utils/Logger.h"
+#include "utils/Metrics.h"
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace beast = boost::beast;
 namespace http = beast::http;
@@ -14,118 +25,557 @@ using tcp = net::ip::tcp;
 
 namespace adapters {
 
+namespace {
+
+struct ConnectionMetrics {
+    utils::Gauge& open;
+    utils::Counter& accepted;
+    utils::Counter& acceptPaused;
+    utils::Counter& idleReaped;
+    utils::Counter& headerTimeouts;
+    utils::Counter& bodyTimeouts;
+    utils::Counter& writeTimeouts;
+    utils::Counter& bodyTooLarge;
+};
+
+ConnectionMetrics& connectionMetrics() {
+    static auto& registry = utils::MetricsRegistry::global();
+    static ConnectionMetrics metrics{
+        registry.gauge("http_open_connections", "Client connections currently open"),
+        registry.counter("http_connections_accepted_total", "Client connections accepted"),
+        registry.counter("http_accept_paused_total",
+                         "Times a listener stopped accepting at the connection limit"),
+        registry.counter("http_idle_connections_reaped_total",
+                         "Keep-alive connections closed after waiting idle for a request"),
+        registry.counter("http_connection_timeouts_total",
+                         "Connections closed for missing a read or write deadline", "phase=\"header\""),
+        registry.counter("http_connection_timeouts_total",
+                         "Connections closed for missing a read or write deadline", "phase=\"body\""),
+        registry.counter("http_connection_timeouts_total",
+                         "Connections closed for missing a read or write deadline", "phase=\"write\""),
+        registry.counter("http_request_body_too_large_total",
+                         "Requests rejected with 413 for exceeding the body size limit")};
+    return metrics;
+}
+
+// Bytes read at a time while waiting for the next request
+constexpr std::size_t kReadChunk = 4096;
+
+http::response<http::string_body> errorResponse(http::status status, const std::string& message) {
+    dto::ErrorResponse error{static_cast<int>(status), message};
+    http::response<http::string_body> res{status, 11};
+    res.set(http::field::content_type, "application/json");
+    res.body() = error.toJson().dump();
+    res.prepare_payload();
+    return res;
+}
+
+// Counts open connections across all listeners. A listener that finds the
+// limit reached stops accepting until a connection closes, so further
+// clients wait in the kernel backlog instead of taking file descriptors.
+class ConnectionSlots {
+public:
+    explicit ConnectionSlots(std::size_t max) : max_(max) {}
+
+    // Takes a slot, or keeps resume to be called once one is released
+    bool acquireOrWait(std::function<void()> resume) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (max_ == 0 || open_ < max_) {
+            ++open_;
+            return true;
+        }
+        waiting_.push_back(std::move(resume));
+        return false;
+    }
+
+    void release() {
+        std::function<void()> resume;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --open_;
+            if (!waiting_.empty()) {
+                resume = std::move(waiting_.front());
+                waiting_.pop_front();
+            }
+        }
+        if (resume) {
+            resume();
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::size_t max_;
+    std::size_t open_{0};
+    std::deque<std::function<void()>> waiting_;
+};
+
+struct CompressionMetrics {
+    utils::Counter& responses;
+    utils::Counter& inputBytes;
+    utils::Counter& outputBytes;
+    utils::Histogram& duration;
+};
+
+CompressionMetrics makeCompressionMetrics(utils::ContentEncoding encoding) {
+    auto& registry = utils::MetricsRegistry::global();
+    auto labels = "encoding=\"" + std::string(utils::contentEncodingName(encoding)) + "\"";
+    return CompressionMetrics{
+        registry.counter("http_compressed_responses_total",
+                         "Responses sent with a compressed body", labels),
+        registry.counter("http_compression_input_bytes_total",
+                         "Body bytes before compression", labels),
+        registry.counter("http_compression_output_bytes_total",
+                         "Body bytes after compression", labels),
+        registry.histogram("http_compression_duration_seconds",
+                           "Time spent compressing response bodies", labels)};
+}
+
+CompressionMetrics& compressionMetrics(utils::ContentEncoding encoding) {
+    static CompressionMetrics gzip = makeCompressionMetrics(utils::ContentEncoding::Gzip);
+    static CompressionMetrics deflate = makeCompressionMetrics(utils::ContentEncoding::Deflate);
+    return encoding == utils::ContentEncoding::Gzip ? gzip : deflate;
+}
+
+std::string_view toStringView(beast::string_view value) {
+    return std::string_view(value.data(), value.size());
+}
+
+bool isCompressible(std::string_view contentType) {
+    return contentType.substr(0, 16) == "application/json" || contentType.substr(0, 5) == "text/" ||
+           contentType.substr(0, 19) == "application/msgpack" ||
+           contentType.substr(0, 16) == "application/cbor";
+}
+
+// Adds Accept-Encoding to what the handler already varies on (Accept)
+void varyOnEncoding(http::response<http::string_body>& res) {
+    auto vary = toStringView(res[http::field::vary]);
+    if (vary.empty()) {
+        res.set(http::field::vary, "Accept-Encoding");
+    } else if (vary.find("Accept-Encoding") == std::string_view::npos) {
+        res.set(http::field::vary, std::string(vary) + ", Accept-Encoding");
+    }
+}
+
+// Replaces the body with a gzip or deflate encoding of it when the client
+// accepts one and the body is large enough to be worth it. The framing
+// the handler chose is kept: a chunked response goes out chunked.
+void compressResponse(const http::request<http::string_body>& req,
+                      http::response<http::string_body>& res,
+                      const utils::CompressionOptions& options) {
+    if (!options.enabled) {
+        return;
+    }
+
+    // Caches must key on Accept-Encoding for anything that may be
+    // compressed, including the 304s that revalidate it
+    bool notModified = res.result() == http::status::not_modified;
+    if (!notModified && !isCompressible(toStringView(res[http::field::content_type]))) {
+        return;
+    }
+    varyOnEncoding(res);
+    if (notModified) {
+        // Echo the tag in the form the client cached it in
+        auto etag = std::string(toStringView(res[http::field::etag]));
+        auto ifNoneMatch = toStringView(req[http::field::if_none_match]);
+        if (!etag.empty() && ifNoneMatch.find("W/" + etag) != std::string_view::npos) {
+            res.set(http::field::etag, "W/" + etag);
+        }
+        return;
+    }
+    if (res.body().size() < options.minSize ||
+        res.count(http::field::content_encoding) > 0) {
+        return;
+    }
+
+    auto encoding = utils::negotiateEncoding(toStringView(req[http::field::accept_encoding]));
+    if (encoding == utils::ContentEncoding::Identity) {
+        return;
+    }
+
+    auto& metrics = compressionMetrics(encoding);
+    auto start = std::chrono::steady_clock::now();
+    auto compressed = utils::Compressor::compress(encoding, options.level, res.body());
+    metrics.duration.observe(std::chrono::steady_clock::now() - start);
+    if (compressed.size() >= res.body().size()) {
+        return;
+    }
+
+    metrics.responses.inc();
+    metrics.inputBytes.inc(res.body().size());
+    metrics.outputBytes.inc(compressed.size());
+
+    res.body() = std::move(compressed);
+    res.set(http::field::content_encoding, std::string(utils::contentEncodingName(encoding)));
+
+    // Same data, different bytes: the strong validator becomes a weak one,
+    // which If-None-Match still accepts
+    auto etag = toStringView(res[http::field::etag]);
+    if (!etag.empty() && etag.front() == '"') {
+        res.set(http::field::etag, "W/" + std::string(etag));
+    }
+
+    if (!res.chunked()) {
+        res.prepare_payload();
+    }
+}
+
+} // namespace
+
 // HTTP session class
+// Serves requests on one connection until the client, a keep-alive limit
+// or a missed deadline closes it. Each phase of a request (waiting for it
+// on a kept-alive connection, its header, its body, the response write)
+// has its own deadline. Pipelined requests already sitting in buffer_ are
+// parsed by the next read and therefore answered in order.
 class HttpSession : public std::enable_shared_from_this<HttpSession> {
 public:
-    HttpSession(tcp::socket socket, std::shared_ptr<RequestHandler> handler)
-        : socket_(std::move(socket)), handler_(handler) {}
+    HttpSession(tcp::socket socket, std::shared_ptr<RequestHandler> handler,
+                const ServerOptions& options, std::shared_ptr<ConnectionSlots> slots)
+        : stream_(std::move(socket)), handler_(handler), options_(options),
+          slots_(std::move(slots)) {
+        connectionMetrics().accepted.inc();
+        connectionMetrics().open.inc();
+    }
+
+    ~HttpSession() {
+        // Give the descriptor back before a paused listener accepts again
+        beast::error_code ec;
+        stream_.socket().close(ec);
+        connectionMetrics().open.dec();
+        slots_->release();
+    }
 
     void run() {
-        doRead();
+        readHeader();
     }
 
 private:
-    tcp::socket socket_;
+    beast::tcp_stream stream_;
     beast::flat_buffer buffer_;
+    std::optional<http::request_parser<http::string_body>> parser_;
     http::request<http::string_body> req_;
+    http::response<http::string_body> res_;
     std::shared_ptr<RequestHandler> handler_;
+    const ServerOptions& options_;
+    std::shared_ptr<ConnectionSlots> slots_;
+    std::size_t requestsServed_{0};
+    bool closeAfterWrite_{false};
+    std::chrono::steady_clock::time_point started_;
 
-    void doRead() {
+    // Waits for the first bytes of the next request; a connection idle for
+    // keepAliveTimeout is reaped
+    void awaitRequest() {
+        if (buffer_.size() > 0) {
+            readHeader();
+            return;
+        }
+
+        stream_.expires_after(options_.keepAliveTimeout);
         auto self = shared_from_this();
-        http::async_read(socket_, buffer_, req_,
+        stream_.async_read_some(buffer_.prepare(kReadChunk),
+            [self](beast::error_code ec, std::size_t bytes) {
+                if (ec == beast::error::timeout) {
+                    connectionMetrics().idleReaped.inc();
+                    return;
+                }
+                if (ec) {
+                    if (ec != net::error::eof && ec != net::error::connection_reset) {
+                        utils::Logger::error("Read error: {}", ec.message());
+                    }
+                    self->doClose();
+                    return;
+                }
+                self->buffer_.commit(bytes);
+                self->readHeader();
+            });
+    }
+
+    void readHeader() {
+        parser_.emplace();
+        parser_->body_limit(options_.maxBodySize);
+        stream_.expires_after(options_.headerTimeout);
+
+        auto self = shared_from_this();
+        http::async_read_header(stream_, buffer_, *parser_,
             [self](beast::error_code ec, std::size_t) {
-                if (!ec) {
+                if (ec) {
+                    self->readFailed(ec, connectionMetrics().headerTimeouts);
+                } else if (self->parser_->is_done()) {
                     self->handleRequest();
                 } else {
-                    utils::Logger::error("Read error: " + ec.message());
+                    self->readBody();
                 }
             });
     }
 
-    void handleRequest() {
-        auto response = handler_->handle(req_);
-        
+    void readBody() {
+        stream_.expires_after(options_.bodyTimeout);
+
         auto self = shared_from_this();
-        http::async_write(socket_, response,
+        http::async_read(stream_, buffer_, *parser_,
             [self](beast::error_code ec, std::size_t) {
                 if (ec) {
-                    utils::Logger::error("Write error: " + ec.message());
+                    self->readFailed(ec, connectionMetrics().bodyTimeouts);
+                    return;
                 }
-                self->socket_.shutdown(tcp::socket::shutdown_send, ec);
+                self->handleRequest();
             });
     }
+
+    void readFailed(beast::error_code ec, utils::Counter& timeouts) {
+        if (ec == http::error::body_limit) {
+            // The rest of the body is never read, so the connection cannot
+            // carry another request
+            connectionMetrics().bodyTooLarge.inc();
+            started_ = std::chrono::steady_clock::now();
+            req_ = parser_->release();
+            res_ = errorResponse(http::status::payload_too_large, "Payload Too Large");
+            closeAfterWrite_ = true;
+            stream_.expires_never();
+            writeResponse();
+        } else if (ec == beast::error::timeout) {
+            timeouts.inc();
+        } else if (ec == http::error::end_of_stream) {
+            doClose();
+        } else {
+            utils::Logger::error("Read error: {}", ec.message());
+        }
+    }
+
+    void handleRequest() {
+        started_ = std::chrono::steady_clock::now();
+        req_ = parser_->release();
+        stream_.expires_never();
+
+        // The handler may finish on a blocking thread; the write resumes on
+        // this session's executor (its strand with a shared io_context)
+        auto self = shared_from_this();
+        handler_->handleAsync(req_, [self](http::response<http::string_body> res) {
+            net::dispatch(self->stream_.get_executor(),
+                [self, res = std::move(res)]() mutable {
+                    self->res_ = std::move(res);
+                    self->writeResponse();
+                });
+        });
+    }
+
+    void writeResponse() {
+        compressResponse(req_, res_, options_.compression);
+        ++requestsServed_;
+
+        bool keepAlive = !closeAfterWrite_ && req_.keep_alive() &&
+                         requestsServed_ < options_.maxRequestsPerConnection;
+        res_.version(req_.version());
+        res_.keep_alive(keepAlive);
+
+        stream_.expires_after(options_.writeTimeout);
+
+        auto self = shared_from_this();
+        http::async_write(stream_, res_,
+            [self, close = res_.need_eof()](beast::error_code ec, std::size_t) {
+                if (ec == beast::error::timeout) {
+                    connectionMetrics().writeTimeouts.inc();
+                    return;
+                }
+                if (ec) {
+                    utils::Logger::error("Write error: {}", ec.message());
+                    return;
+                }
+                self->logAccess();
+                if (close) {
+                    self->doClose();
+                    return;
+                }
+                self->awaitRequest();
+            });
+    }
+
+    void logAccess() {
+        auto status = res_.result_int();
+        if (!utils::Logger::sampleAccess(status)) {
+            return;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started_);
+        auto method = req_.method_string();
+        auto target = req_.target();
+        utils::Logger::access(std::string_view(method.data(), method.size()),
+                              std::string_view(target.data(), target.size()),
+                              status, res_.body().size(), elapsed);
+    }
+
+    void doClose() {
+        beast::error_code ec;
+        stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+    }
 };
 
 // Listener class
 class Listener : public std::enable_shared_from_this<Listener> {
 public:
     Listener(net::io_context& ioc, tcp::endpoint endpoint,
-             std::shared_ptr<RequestHandler> handler)
-        : ioc_(ioc), acceptor_(ioc), handler_(handler) {
+             std::shared_ptr<RequestHandler> handler, const ServerOptions& options,
+             std::shared_ptr<ConnectionSlots> slots)
+        : ioc_(ioc), acceptor_(ioc), handler_(handler), options_(options),
+          slots_(std::move(slots)) {
         beast::error_code ec;
 
         acceptor_.open(endpoint.protocol(), ec);
         if (ec) {
-            utils::Logger::error("Open error: " + ec.message());
+            utils::Logger::error("Open error: {}", ec.message());
             return;
         }
 
         acceptor_.set_option(net::socket_base::reuse_address(true), ec);
         if (ec) {
-            utils::Logger::error("Set option error: " + ec.message());
+            utils::Logger::error("Set option error: {}", ec.message());
             return;
         }
 
+        if (options_.model == ExecutionModel::ThreadPerCore) {
+#ifdef SO_REUSEPORT
+            using reuse_port = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+            acceptor_.set_option(reuse_port(true), ec);
+            if (ec) {
+                utils::Logger::error("Set SO_REUSEPORT error: {}", ec.message());
+                return;
+            }
+#else
+            utils::Logger::warn("SO_REUSEPORT is not supported on this platform");
+#endif
+        }
+
         acceptor_.bind(endpoint, ec);
         if (ec) {
-            utils::Logger::error("Bind error: " + ec.message());
+            utils::Logger::error("Bind error: {}", ec.message());
             return;
         }
 
         acceptor_.listen(net::socket_base::max_listen_connections, ec);
         if (ec) {
-            utils::Logger::error("Listen error: " + ec.message());
+            utils::Logger::error("Listen error: {}", ec.message());
             return;
         }
     }
 
     void run() {
-        doAccept();
+        if (acceptor_.is_open()) {
+            doAccept();
+        }
     }
 
 private:
     net::io_context& ioc_;
     tcp::acceptor acceptor_;
     std::shared_ptr<RequestHandler> handler_;
+    const ServerOptions& options_;
+    std::shared_ptr<ConnectionSlots> slots_;
 
     void doAccept() {
+        auto self = shared_from_this();
+        if (!slots_->acquireOrWait([self] {
+                net::post(self->ioc_, [self] { self->doAccept(); });
+            })) {
+            connectionMetrics().acceptPaused.inc();
+            return;
+        }
+
+        // Each connection gets its own strand so a session's handlers never
+        // run concurrently when several threads share the io_context
         acceptor_.async_accept(
-            [self = shared_from_this()](beast::error_code ec, tcp::socket socket) {
+            net::make_strand(ioc_),
+            [self](beast::error_code ec, tcp::socket socket) {
                 if (!ec) {
-                    std::make_shared<HttpSession>(std::move(socket), self->handler_)->run();
+                    std::make_shared<HttpSession>(std::move(socket), self->handler_,
+                                                  self->options_, self->slots_)->run();
+                } else {
+                    self->slots_->release();
                 }
                 self->doAccept();
             });
     }
 };
 
+namespace {
+
+void pinCurrentThread(std::size_t index) {
+#ifdef __linux__
+    auto cores = std::thread::hardware_concurrency();
+    if (cores == 0) {
+        return;
+    }
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(index % cores, &cpuset);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    if (rc != 0) {
+        utils::Logger::warn("Failed to pin thread {} to CPU {}", index, index % cores);
+    }
+#else
+    (void)index;
+#endif
+}
+
+} // namespace
+
 HttpServer::HttpServer(const std::string& address, unsigned short port,
-                       std::shared_ptr<RequestHandler> handler)
-    : address_(address), port_(port), handler_(handler) {}
+                       std::shared_ptr<RequestHandler> handler,
+                       ServerOptions options)
+    : address_(address), port_(port), handler_(handler), options_(options) {
+    if (options_.threads == 0) {
+        options_.threads = 1;
+    }
+
+    if (options_.model == ExecutionModel::ThreadPerCore) {
+        for (std::size_t i = 0; i < options_.threads; ++i) {
+            contexts_.push_back(std::make_unique<net::io_context>(1));
+        }
+    } else {
+        contexts_.push_back(std::make_unique<net::io_context>(
+            static_cast<int>(options_.threads)));
+    }
+}
 
 void HttpServer::run() {
     auto const address = net::ip::make_address(address_);
     auto const endpoint = tcp::endpoint{address, port_};
 
-    utils::Logger::info("Starting HTTP server on " + address_ + ":" + std::to_string(port_));
+    bool perCore = options_.model == ExecutionModel::ThreadPerCore;
+    utils::Logger::info("Starting HTTP server on {}:{} with {} thread(s), {} model",
+                        address_, port_, options_.threads,
+                        perCore ? "thread-per-core" : "shared io_context");
 
-    std::make_shared<Listener>(ioc_, endpoint, handler_)->run();
+    auto slots = std::make_shared<ConnectionSlots>(options_.maxConnections);
+    for (auto& ioc : contexts_) {
+        std::make_shared<Listener>(*ioc, endpoint, handler_, options_, slots)->run();
+    }
 
-    ioc_.run();
+    threads_.reserve(options_.threads - 1);
+    for (std::size_t i = 1; i < options_.threads; ++i) {
+        threads_.emplace_back([this, i] { runContext(i); });
+    }
+
+    // The calling thread serves as worker 0
+    runContext(0);
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
 }
 
 void HttpServer::stop() {
-    ioc_.stop();
+    for (auto& ioc : contexts_) {
+        ioc->stop();
+    }
+}
+
+void HttpServer::runContext(std::size_t index) {
+    if (options_.pinThreads) {
+        pinCurrentThread(index);
+    }
+    contexts_[index % contexts_.size()]->run();
 }
 
 } // namespace adapters
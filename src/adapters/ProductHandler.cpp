@@ -1,87 +1,434 @@
 #include "adapters/ProductHandler.h"
+#include "adapters/QueryParams.h"
+#include "utils/Compression.h"
+#include "utils/ETag.h"
 #include "utils/Logger.h"
+#include "utils/ObjectId.h"
+#include "utils/Serialization.h"
+#include <boost/asio/post.hpp>
 #include <nlohmann/json.hpp>
-#include <regex>
+#include <algorithm>
+#include <unordered_set>
 
 namespace adapters {
 
-ProductHandler::ProductHandler(std::shared_ptr<service::ProductService> service)
-    : service_(service) {}
+namespace {
 
-http::response<http::string_body> 
-ProductHandler::handleRequest(const http::request<http::string_body>& req) {
-    std::string path(req.target());
-    auto method = req.method();
+std::string_view toStringView(boost::beast::string_view value) {
+    return std::string_view(value.data(), value.size());
+}
 
-    utils::Logger::info(std::string(http::to_string(method)) + " " + path);
+// Parses a positive page size; returns 0 when the value is not a number
+std::size_t parsePageSize(std::string_view value) {
+    if (value.empty() || value.size() > 9) {
+        return 0;
+    }
+    std::size_t result = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') {
+            return 0;
+        }
+        result = result * 10 + static_cast<std::size_t>(c - '0');
+    }
+    return result;
+}
 
-    // Remove query parameters from path for routing
-    size_t queryPos = path.find('?');
-    std::string routePath = (queryPos != std::string::npos) ? path.substr(0, queryPos) : path;
+// Format the client asked for in Accept
+utils::MediaType responseType(const http::request<http::string_body>& req) {
+    return utils::negotiateMediaType(toStringView(req[http::field::accept]));
+}
+
+// Format of the request body, from its Content-Type
+utils::MediaType requestType(const http::request<http::string_body>& req) {
+    return utils::bodyMediaType(toStringView(req[http::field::content_type]));
+}
 
-    // Route: GET /products
-    if (method == http::verb::get && routePath == "/products") {
-        return handleGetAllProducts(req);
+std::string invalidBody(utils::MediaType type, const std::exception& e) {
+    switch (type) {
+        case utils::MediaType::MessagePack:
+            return "Invalid MessagePack: " + std::string(e.what());
+        case utils::MediaType::Cbor:
+            return "Invalid CBOR: " + std::string(e.what());
+        case utils::MediaType::Json:
+            break;
     }
-    
-    // Route: GET /products/{id}
-    if (method == http::verb::get && routePath.find("/products/") == 0) {
-        std::string id = extractIdFromPath(routePath);
-        if (!id.empty()) {
-            return handleGetProduct(id);
-        }
+    return "Invalid JSON: " + std::string(e.what());
+}
+
+// Builds a response whose body is written in place by writeBody, which
+// is called with the writer for type
+template <typename WriteBody>
+http::response<http::string_body> serializedResponse(utils::MediaType type,
+                                                     http::status status,
+                                                     std::size_t sizeHint,
+                                                     WriteBody&& writeBody) {
+    http::response<http::string_body> res{status, 11};
+    res.set(http::field::content_type, std::string(utils::mediaTypeName(type)));
+    res.body().reserve(sizeHint);
+    utils::serialize(type, res.body(), writeBody);
+    res.prepare_payload();
+    return res;
+}
+
+// Same, for a body in the format negotiated from Accept
+template <typename WriteBody>
+http::response<http::string_body> negotiatedResponse(utils::MediaType type,
+                                                     http::status status,
+                                                     std::size_t sizeHint,
+                                                     WriteBody&& writeBody) {
+    auto res = serializedResponse(type, status, sizeHint, std::forward<WriteBody>(writeBody));
+    res.set(http::field::vary, "Accept");
+    return res;
+}
+
+// Strong validator for a response, computed from its DTO before
+// serialization. Each format has its own; JSON keeps the tags it always had.
+template <typename Dto>
+std::string etagOf(const Dto& dto, utils::MediaType type) {
+    utils::ETag etag;
+    dto.hashInto(etag);
+    if (type != utils::MediaType::Json) {
+        etag.add(utils::mediaTypeName(type));
     }
-    
-    // Route: POST /products
-    if (method == http::verb::post && routePath == "/products") {
-        return handleCreateProduct(req);
+    return etag.str();
+}
+
+bool clientHasCurrent(const http::request<http::string_body>& req, const std::string& etag) {
+    auto ifNoneMatch = req[http::field::if_none_match];
+    return !ifNoneMatch.empty() && utils::ETag::matches(toStringView(ifNoneMatch), etag);
+}
+
+http::response<http::string_body> notModifiedResponse(const std::string& etag) {
+    // No Content-Length: a 304 has no body, and 0 would misstate the entity
+    http::response<http::string_body> res{http::status::not_modified, 11};
+    res.set(http::field::etag, etag);
+    res.set(http::field::vary, "Accept");
+    return res;
+}
+
+// Rough serialized size of one product, used to presize bodies
+constexpr std::size_t kProductSizeHint = 192;
+
+constexpr unsigned kMinStatus = 100;
+constexpr unsigned kMaxStatus = 599;
+
+} // namespace
+
+// Histograms are registered on first use of a (route, status) pair and
+// cached here, so recording a request never takes the registry lock
+struct ProductHandler::RouteMetrics {
+    std::string labels;
+    std::array<std::atomic<utils::Histogram*>, kMaxStatus - kMinStatus + 1> byStatus{};
+};
+
+ProductHandler::ProductHandler(std::shared_ptr<service::ProductService> service,
+                               ProductHandlerOptions options,
+                               std::shared_ptr<ResponseCache> responseCache)
+    : service_(service), options_(options), responseCache_(std::move(responseCache)),
+      admission_(options.admission),
+      inFlight_(utils::MetricsRegistry::global().gauge(
+          "http_requests_in_flight", "Requests currently being handled")) {
+    // Route table, built once; matching never allocates
+    router_.add(http::verb::get, "/products",
+        [this](const Request& req, const RouteParams&) {
+            return handleGetAllProducts(req);
+        });
+    router_.add(http::verb::get, "/products/{id:oid}",
+        [this](const Request& req, const RouteParams& params) {
+            return handleGetProduct(std::string(params.get("id")), req);
+        });
+    router_.add(http::verb::post, "/products",
+        [this](const Request& req, const RouteParams&) {
+            return handleCreateProduct(req);
+        });
+    router_.add(http::verb::post, "/products/_bulk",
+        [this](const Request& req, const RouteParams&) {
+            return handleBulkWrite(req);
+        });
+    router_.add(http::verb::put, "/products/{id:oid}",
+        [this](const Request& req, const RouteParams& params) {
+            return handleUpdateProduct(std::string(params.get("id")), req);
+        });
+    router_.add(http::verb::patch, "/products/{id:oid}",
+        [this](const Request& req, const RouteParams& params) {
+            return handlePatchProduct(std::string(params.get("id")), req);
+        });
+    router_.add(http::verb::post, "/products/{id:oid}/reserve",
+        [this](const Request& req, const RouteParams& params) {
+            return handleStockChange(std::string(params.get("id")), req, true);
+        });
+    router_.add(http::verb::post, "/products/{id:oid}/release",
+        [this](const Request& req, const RouteParams& params) {
+            return handleStockChange(std::string(params.get("id")), req, false);
+        });
+    router_.add(http::verb::post, "/products/_reserve",
+        [this](const Request& req, const RouteParams&) {
+            return handleStockBatch(req, true);
+        });
+    router_.add(http::verb::post, "/products/_release",
+        [this](const Request& req, const RouteParams&) {
+            return handleStockBatch(req, false);
+        });
+    router_.add(http::verb::delete_, "/products/{id:oid}",
+        [this](const Request& req, const RouteParams& params) {
+            return handleDeleteProduct(std::string(params.get("id")), req);
+        });
+    router_.add(http::verb::get, "/health",
+        [this](const Request&, const RouteParams&) {
+            nlohmann::json health = {{"status", "healthy"}, {"service", "product-catalog"}};
+            return createJsonResponse(http::status::ok, health);
+        });
+    router_.add(http::verb::get, "/metrics",
+        [this](const Request&, const RouteParams&) {
+            return handleMetrics();
+        });
+
+    for (std::size_t i = 0; i < router_.size(); ++i) {
+        const auto& route = router_.route(i);
+        bool exempt = route.pattern == "/health" || route.pattern == "/metrics";
+        admission_.addRoute(std::string(http::to_string(route.method)), route.pattern, exempt);
+        routeBlocks_.push_back(!exempt);
     }
-    
-    // Route: PUT /products/{id}
-    if (method == http::verb::put && routePath.find("/products/") == 0) {
-        std::string id = extractIdFromPath(routePath);
-        if (!id.empty()) {
-            return handleUpdateProduct(id, req);
+
+    // One slot per route, then one for requests no route matched
+    for (std::size_t i = 0; i <= router_.size(); ++i) {
+        auto metrics = std::make_unique<RouteMetrics>();
+        if (i < router_.size()) {
+            const auto& route = router_.route(i);
+            metrics->labels = "method=\"" + std::string(http::to_string(route.method)) +
+                              "\",route=\"" + utils::MetricsRegistry::escapeLabel(route.pattern) + "\"";
+        } else {
+            metrics->labels = "method=\"\",route=\"unmatched\"";
         }
+        routeMetrics_.push_back(std::move(metrics));
     }
-    
-    // Route: DELETE /products/{id}
-    if (method == http::verb::delete_ && routePath.find("/products/") == 0) {
-        std::string id = extractIdFromPath(routePath);
-        if (!id.empty()) {
-            return handleDeleteProduct(id);
+}
+
+ProductHandler::~ProductHandler() = default;
+
+http::response<http::string_body> 
+ProductHandler::handleRequest(const http::request<http::string_body>& req) {
+    return handleAdmitted(req, admit(req));
+}
+
+ProductHandler::Admission ProductHandler::admit(const http::request<http::string_body>& req) {
+    auto target = toStringView(req.target());
+
+    Admission admission;
+    admission.start = std::chrono::steady_clock::now();
+    inFlight_.inc();
+
+    // Query parameters are not part of routing
+    admission.route = router_.match(req.method(), target.substr(0, target.find('?')),
+                                    admission.params);
+    admission.admitted = !admission.route || admission_.tryAcquire(admission.route->index);
+    return admission;
+}
+
+http::response<http::string_body>
+ProductHandler::handleAdmitted(const http::request<http::string_body>& req,
+                               const Admission& admission) {
+    auto route = admission.route;
+
+    http::response<http::string_body> res;
+    if (!admission.admitted) {
+        res = createOverloadedResponse();
+    } else {
+        try {
+            res = route ? route->handler(req, admission.params)
+                        : createErrorResponse(404, "Not Found");
+        } catch (...) {
+            if (route) {
+                admission_.release(route->index);
+            }
+            inFlight_.dec();
+            throw;
+        }
+        if (route) {
+            admission_.release(route->index);
         }
     }
-    
-    // Route: GET /health
-    if (method == http::verb::get && routePath == "/health") {
-        nlohmann::json health = {{"status", "healthy"}, {"service", "product-catalog"}};
-        return createJsonResponse(http::status::ok, health);
+
+    inFlight_.dec();
+    recordRequest(route ? route->index : router_.size(), res.result_int(),
+                  std::chrono::steady_clock::now() - admission.start);
+    return res;
+}
+
+http::response<http::string_body> ProductHandler::shed(const Admission& admission) {
+    if (admission.admitted && admission.route) {
+        admission_.release(admission.route->index);
     }
+    inFlight_.dec();
 
-    return createErrorResponse(404, "Not Found");
+    auto res = createOverloadedResponse();
+    recordRequest(admission.route ? admission.route->index : router_.size(), res.result_int(),
+                  std::chrono::steady_clock::now() - admission.start);
+    return res;
+}
+
+bool ProductHandler::mayBlock(const Admission& admission) const {
+    return admission.admitted && admission.route && routeBlocks_[admission.route->index];
+}
+
+void ProductHandler::recordRequest(std::size_t routeIndex, unsigned status,
+                                   std::chrono::steady_clock::duration elapsed) {
+    if (status < kMinStatus || status > kMaxStatus) {
+        return;
+    }
+
+    auto& metrics = *routeMetrics_[routeIndex];
+    auto& slot = metrics.byStatus[status - kMinStatus];
+    auto* histogram = slot.load(std::memory_order_acquire);
+    if (!histogram) {
+        // Registration is idempotent, so racing threads end up with the same series
+        histogram = &utils::MetricsRegistry::global().histogram(
+            "http_request_duration_seconds",
+            "Time spent handling HTTP requests, by route and status",
+            metrics.labels + ",status=\"" + std::to_string(status) + "\"");
+        slot.store(histogram, std::memory_order_release);
+    }
+    histogram->observe(elapsed);
 }
 
 http::response<http::string_body> 
 ProductHandler::handleGetAllProducts(const http::request<http::string_body>& req) {
-    std::string category = extractQueryParam(std::string(req.target()), "category");
+    QueryParams query(toStringView(req.target()));
+    if (query.has("ids")) {
+        return handleGetProductsByIds(query.get("ids"), req);
+    }
+
+    std::string category(query.get("category"));
+    std::string after(query.get("after"));
+    auto limitParam = query.get("limit");
+
+    std::size_t limit = options_.defaultPageSize;
+    if (!limitParam.empty()) {
+        limit = parsePageSize(limitParam);
+        if (limit == 0) {
+            return createErrorResponse(400, "Invalid limit");
+        }
+    }
+    limit = std::min(limit, options_.maxPageSize);
+
+    if (!after.empty() && !utils::ObjectId::isValid(after)) {
+        return createErrorResponse(400, "Invalid cursor");
+    }
+
+    auto type = responseType(req);
+
+    // The category goes last: the other parts never contain a '/' of their own
+    std::string cacheKey;
+    ResponseCache::Stamp stamp;
+    if (responseCache_) {
+        cacheKey = std::string(utils::mediaTypeName(type)) + "/" + after + "/" +
+                   std::to_string(limit) + "/" + category;
+        if (auto cached = responseCache_->get(cacheKey, category)) {
+            return createCachedResponse(*cached, req);
+        }
+        stamp = responseCache_->stamp(category);
+    }
     
-    auto [products, error] = service_->getAllProducts(category);
+    auto [page, error] = service_->getProductPage(category, after, limit);
     
     if (error) {
         return createErrorResponse(error->getHttpCode(), error->getMessage());
     }
-    
-    nlohmann::json jsonArray = nlohmann::json::array();
-    for (const auto& product : products) {
-        jsonArray.push_back(product.toJson());
+
+    // Pollers of an unchanged page get a 304 without the body being built
+    auto etag = etagOf(page, type);
+    if (clientHasCurrent(req, etag)) {
+        return notModifiedResponse(etag);
     }
     
-    return createJsonResponse(http::status::ok, jsonArray);
+    auto res = negotiatedResponse(type, http::status::ok,
+        page.items.size() * kProductSizeHint + 2,
+        [&page](auto& writer) {
+            writer.beginArray(page.items.size());
+            for (const auto& product : page.items) {
+                product.write(writer);
+            }
+            writer.endArray();
+        });
+    if (!page.nextCursor.empty()) {
+        std::string next = "/products?";
+        if (!category.empty()) {
+            next += "category=" + QueryParams::encode(category) + "&";
+        }
+        next += "limit=" + std::to_string(limit) + "&after=" + page.nextCursor;
+        res.set("X-Next-Cursor", page.nextCursor);
+        res.set(http::field::link, "<" + next + ">; rel=\"next\"");
+    }
+    res.set(http::field::etag, etag);
+
+    if (responseCache_) {
+        CachedResponse cached;
+        cached.body = res.body();
+        cached.type = type;
+        cached.etag = etag;
+        if (!page.nextCursor.empty()) {
+            cached.headers.emplace_back("X-Next-Cursor", std::string(res["X-Next-Cursor"]));
+            cached.headers.emplace_back("Link", std::string(res[http::field::link]));
+        }
+        responseCache_->put(cacheKey, stamp, std::move(cached));
+    }
+    return res;
+}
+
+http::response<http::string_body> 
+ProductHandler::handleGetProductsByIds(std::string_view idList,
+                                       const http::request<http::string_body>& req) {
+    // Comma separated; ids are normalized first, so duplicates differing
+    // only in case are collapsed too, keeping the first position
+    std::vector<std::string> ids;
+    std::unordered_set<std::string> seen;
+    while (!idList.empty()) {
+        auto comma = idList.find(',');
+        auto id = idList.substr(0, comma);
+        idList = comma == std::string_view::npos ? std::string_view{} : idList.substr(comma + 1);
+
+        if (id.empty()) {
+            continue;
+        }
+        if (!utils::ObjectId::isValid(id)) {
+            return createErrorResponse(400, "Invalid id: " + std::string(id));
+        }
+        auto normalized = utils::ObjectId::normalize(id);
+        if (seen.insert(normalized).second) {
+            ids.push_back(std::move(normalized));
+        }
+    }
+
+    if (ids.empty()) {
+        return createErrorResponse(400, "No ids");
+    }
+    if (ids.size() > options_.maxPageSize) {
+        return createErrorResponse(400, "Too many ids (max " +
+                                   std::to_string(options_.maxPageSize) + ")");
+    }
+
+    auto [batch, error] = service_->getProductsByIds(ids);
+
+    if (error) {
+        return createErrorResponse(error->getHttpCode(), error->getMessage());
+    }
+
+    auto type = responseType(req);
+    auto etag = etagOf(batch, type);
+    if (clientHasCurrent(req, etag)) {
+        return notModifiedResponse(etag);
+    }
+
+    auto res = negotiatedResponse(type, http::status::ok,
+        batch.items.size() * kProductSizeHint + batch.missing.size() * 28 + 32,
+        [&batch](auto& writer) { batch.write(writer); });
+    res.set(http::field::etag, etag);
+    return res;
 }
 
 http::response<http::string_body> 
-ProductHandler::handleGetProduct(const std::string& id) {
+ProductHandler::handleGetProduct(const std::string& id,
+                                 const http::request<http::string_body>& req) {
     auto [product, error] = service_->getProduct(id);
     
     if (error) {
@@ -92,13 +439,22 @@ ProductHandler::handleGetProduct(const std::string& id) {
         return createErrorResponse(404, "Product not found");
     }
     
-    return createJsonResponse(http::status::ok, product->toJson());
+    auto type = responseType(req);
+    auto etag = etagOf(*product, type);
+    if (clientHasCurrent(req, etag)) {
+        return notModifiedResponse(etag);
+    }
+
+    auto res = createProductResponse(http::status::ok, *product, type);
+    res.set(http::field::etag, etag);
+    return res;
 }
 
 http::response<http::string_body> 
 ProductHandler::handleCreateProduct(const http::request<http::string_body>& req) {
+    auto bodyType = requestType(req);
     try {
-        auto json = nlohmann::json::parse(req.body());
+        auto json = utils::parseBody(bodyType, req.body());
         auto request = dto::CreateProductRequest::fromJson(json);
         
         auto [product, error] = service_->createProduct(request);
@@ -107,17 +463,18 @@ ProductHandler::handleCreateProduct(const http::request<http::string_body>& req)
             return createErrorResponse(error->getHttpCode(), error->getMessage());
         }
         
-        return createJsonResponse(http::status::created, product.toJson());
+        return createProductResponse(http::status::created, product, responseType(req));
     } catch (const std::exception& e) {
-        return createErrorResponse(400, "Invalid JSON: " + std::string(e.what()));
+        return createErrorResponse(400, invalidBody(bodyType, e));
     }
 }
 
 http::response<http::string_body> 
 ProductHandler::handleUpdateProduct(const std::string& id, 
                                     const http::request<http::string_body>& req) {
+    auto bodyType = requestType(req);
     try {
-        auto json = nlohmann::json::parse(req.body());
+        auto json = utils::parseBody(bodyType, req.body());
         auto request = dto::UpdateProductRequest::fromJson(json, id);
         
         auto [product, error] = service_->updateProduct(request);
@@ -126,14 +483,88 @@ ProductHandler::handleUpdateProduct(const std::string& id,
             return createErrorResponse(error->getHttpCode(), error->getMessage());
         }
         
-        return createJsonResponse(http::status::ok, product.toJson());
+        return createProductResponse(http::status::ok, product, responseType(req));
     } catch (const std::exception& e) {
-        return createErrorResponse(400, "Invalid JSON: " + std::string(e.what()));
+        return createErrorResponse(400, invalidBody(bodyType, e));
     }
 }
 
 http::response<http::string_body> 
-ProductHandler::handleDeleteProduct(const std::string& id) {
+ProductHandler::handlePatchProduct(const std::string& id,
+                                   const http::request<http::string_body>& req) {
+    auto bodyType = requestType(req);
+    try {
+        auto json = utils::parseBody(bodyType, req.body());
+        auto request = dto::PatchProductRequest::fromJson(json, id);
+
+        auto [product, error] = service_->patchProduct(request);
+
+        if (error) {
+            return createErrorResponse(error->getHttpCode(), error->getMessage());
+        }
+
+        return createProductResponse(http::status::ok, product, responseType(req));
+    } catch (const std::exception& e) {
+        return createErrorResponse(400, invalidBody(bodyType, e));
+    }
+}
+
+http::response<http::string_body>
+ProductHandler::handleStockChange(const std::string& id,
+                                  const http::request<http::string_body>& req, bool reserve) {
+    dto::StockChangeRequest request;
+    auto bodyType = requestType(req);
+    try {
+        auto json = utils::parseBody(bodyType, req.body());
+        request = dto::StockChangeRequest::fromJson(json, id);
+    } catch (const std::exception& e) {
+        return createErrorResponse(400, invalidBody(bodyType, e));
+    }
+
+    auto [stock, error] = reserve ? service_->reserveStock(request)
+                                  : service_->releaseStock(request);
+
+    if (error) {
+        return createErrorResponse(error->getHttpCode(), error->getMessage());
+    }
+
+    return negotiatedResponse(responseType(req), http::status::ok, 64,
+        [&stock](auto& writer) { stock.write(writer); });
+}
+
+http::response<http::string_body>
+ProductHandler::handleStockBatch(const http::request<http::string_body>& req, bool reserve) {
+    dto::StockBatchRequest request;
+    auto bodyType = requestType(req);
+    try {
+        auto json = utils::parseBody(bodyType, req.body());
+        request = dto::StockBatchRequest::fromJson(json);
+    } catch (const std::exception& e) {
+        return createErrorResponse(400, invalidBody(bodyType, e));
+    }
+
+    if (request.items.empty()) {
+        return createErrorResponse(400, "No items");
+    }
+    if (request.items.size() > options_.maxBulkOperations) {
+        return createErrorResponse(400, "Too many items (max " +
+                                   std::to_string(options_.maxBulkOperations) + ")");
+    }
+
+    auto [response, error] = reserve ? service_->reserveStockBatch(request)
+                                     : service_->releaseStockBatch(request);
+
+    if (error) {
+        return createErrorResponse(error->getHttpCode(), error->getMessage());
+    }
+
+    return negotiatedResponse(responseType(req), http::status::ok, response.items.size() * 64 + 16,
+        [&response](auto& writer) { response.write(writer); });
+}
+
+http::response<http::string_body> 
+ProductHandler::handleDeleteProduct(const std::string& id,
+                                    const http::request<http::string_body>& req) {
     auto error = service_->deleteProduct(id);
     
     if (error) {
@@ -141,7 +572,49 @@ ProductHandler::handleDeleteProduct(const std::string& id) {
     }
     
     nlohmann::json response = {{"message", "Product deleted successfully"}};
-    return createJsonResponse(http::status::ok, response);
+    auto res = createJsonResponse(http::status::ok, response, responseType(req));
+    res.set(http::field::vary, "Accept");
+    return res;
+}
+
+http::response<http::string_body> 
+ProductHandler::handleBulkWrite(const http::request<http::string_body>& req) {
+    dto::BulkWriteRequest request;
+    auto bodyType = requestType(req);
+    try {
+        auto json = utils::parseBody(bodyType, req.body());
+        request = dto::BulkWriteRequest::fromJson(json);
+    } catch (const std::exception& e) {
+        return createErrorResponse(400, invalidBody(bodyType, e));
+    }
+
+    if (request.operations.empty()) {
+        return createErrorResponse(400, "No operations");
+    }
+    if (request.operations.size() > options_.maxBulkOperations) {
+        return createErrorResponse(400, "Too many operations (max " +
+                                   std::to_string(options_.maxBulkOperations) + ")");
+    }
+
+    auto [response, error] = service_->bulkWrite(request);
+
+    if (error) {
+        return createErrorResponse(error->getHttpCode(), error->getMessage());
+    }
+
+    // Per-item statuses are in the body; the batch itself succeeded
+    return negotiatedResponse(responseType(req), http::status::ok,
+        response.results.size() * 64 + 48,
+        [&response](auto& writer) { response.write(writer); });
+}
+
+http::response<http::string_body> 
+ProductHandler::handleMetrics() {
+    http::response<http::string_body> res{http::status::ok, 11};
+    res.set(http::field::content_type, "text/plain; version=0.0.4");
+    res.body() = utils::MetricsRegistry::global().render();
+    res.prepare_payload();
+    return res;
 }
 
 http::response<http::string_body> 
@@ -154,61 +627,137 @@ ProductHandler::createResponse(http::status status, const std::string& body) {
 }
 
 http::response<http::string_body> 
-ProductHandler::createJsonResponse(http::status status, const nlohmann::json& json) {
+ProductHandler::createJsonResponse(http::status status, const nlohmann::json& json,
+                                   utils::MediaType type) {
     http::response<http::string_body> res{status, 11};
-    res.set(http::field::content_type, "application/json");
-    res.body() = json.dump();
+    res.set(http::field::content_type, std::string(utils::mediaTypeName(type)));
+    res.body() = utils::dumpBody(type, json);
     res.prepare_payload();
     return res;
 }
 
 http::response<http::string_body> 
-ProductHandler::createErrorResponse(int code, const std::string& message) {
-    dto::ErrorResponse error{code, message};
-    return createJsonResponse(static_cast<http::status>(code), error.toJson());
+ProductHandler::createProductResponse(http::status status, const dto::ProductResponse& product,
+                                      utils::MediaType type) {
+    return negotiatedResponse(type, status, kProductSizeHint,
+        [&product](auto& writer) { product.write(writer); });
 }
 
-std::string ProductHandler::extractIdFromPath(const std::string& path) {
-    std::regex pattern("/products/([a-fA-F0-9]{24})");
-    std::smatch matches;
-    if (std::regex_match(path, matches, pattern) && matches.size() > 1) {
-        return matches[1].str();
+http::response<http::string_body>
+ProductHandler::createCachedResponse(const CachedResponse& cached,
+                                     const http::request<http::string_body>& req) {
+    if (clientHasCurrent(req, cached.etag)) {
+        return notModifiedResponse(cached.etag);
     }
-    return "";
-}
 
-std::string ProductHandler::extractQueryParam(const std::string& target, 
-                                              const std::string& param) {
-    size_t queryPos = target.find('?');
-    if (queryPos == std::string::npos) {
-        return "";
-    }
-    
-    std::string query = target.substr(queryPos + 1);
-    std::string searchParam = param + "=";
-    size_t paramPos = query.find(searchParam);
-    
-    if (paramPos == std::string::npos) {
-        return "";
+    // Clients that prefer deflate get the plain body, compressed on the way out
+    bool gzip = !cached.gzipBody.empty() &&
+                utils::negotiateEncoding(toStringView(req[http::field::accept_encoding])) ==
+                    utils::ContentEncoding::Gzip;
+
+    http::response<http::string_body> res{http::status::ok, 11};
+    res.set(http::field::content_type, std::string(utils::mediaTypeName(cached.type)));
+    for (const auto& [name, value] : cached.headers) {
+        res.set(name, value);
     }
-    
-    size_t startPos = paramPos + searchParam.length();
-    size_t endPos = query.find('&', startPos);
-    
-    if (endPos == std::string::npos) {
-        return query.substr(startPos);
+    if (gzip) {
+        res.body() = cached.gzipBody;
+        res.set(http::field::content_encoding, "gzip");
+        res.set(http::field::vary, "Accept, Accept-Encoding");
+        res.set(http::field::etag, "W/" + cached.etag);
     } else {
-        return query.substr(startPos, endPos - startPos);
+        res.body() = cached.body;
+        res.set(http::field::vary, "Accept");
+        res.set(http::field::etag, cached.etag);
     }
+    res.prepare_payload();
+    return res;
+}
+
+http::response<http::string_body> 
+ProductHandler::createErrorResponse(int code, const std::string& message) {
+    dto::ErrorResponse error{code, message};
+    // Always JSON, like the errors HttpServer answers with itself, so
+    // clients need a single error decoder
+    return serializedResponse(utils::MediaType::Json, static_cast<http::status>(code),
+        64 + message.size(), [&error](auto& writer) { error.write(writer); });
+}
+
+http::response<http::string_body>
+ProductHandler::createOverloadedResponse() {
+    auto res = createErrorResponse(503, "Service overloaded, retry later");
+    res.set(http::field::retry_after, std::to_string(admission_.retryAfter().count()));
+    return res;
 }
 
 // RequestHandler implementation
-RequestHandler::RequestHandler(std::shared_ptr<ProductHandler> productHandler)
-    : productHandler_(productHandler) {}
+RequestHandler::RequestHandler(std::shared_ptr<ProductHandler> productHandler,
+                               RequestHandlerOptions options)
+    : productHandler_(productHandler),
+      options_(options),
+      queueDepth_(utils::MetricsRegistry::global().gauge(
+          "http_blocking_queue_depth", "Requests waiting for a blocking thread")),
+      queueWait_(utils::MetricsRegistry::global().histogram(
+          "http_blocking_queue_wait_seconds", "Time requests waited for a blocking thread")),
+      rejected_(utils::MetricsRegistry::global().counter(
+          "http_blocking_queue_rejected_total",
+          "Requests shed with 503 because the blocking queue was full")) {
+    if (options_.blockingThreads > 0) {
+        blockingPool_ = std::make_unique<boost::asio::thread_pool>(options_.blockingThreads);
+    }
+}
+
+RequestHandler::~RequestHandler() {
+    if (blockingPool_) {
+        blockingPool_->join();
+    }
+}
 
 http::response<http::string_body> 
 RequestHandler::handle(const http::request<http::string_body>& req) {
     return productHandler_->handleRequest(req);
 }
 
+void RequestHandler::handleAsync(const http::request<http::string_body>& req, Completion done) {
+    // Admitted before it may wait for a thread, so queued requests count
+    // against the admission limits until they are answered
+    auto admission = productHandler_->admit(req);
+
+    if (!blockingPool_ || !productHandler_->mayBlock(admission)) {
+        done(run(req, admission));
+        return;
+    }
+
+    if (queued_.fetch_add(1, std::memory_order_acq_rel) >= options_.maxQueued &&
+        options_.maxQueued > 0) {
+        queued_.fetch_sub(1, std::memory_order_acq_rel);
+        rejected_.inc();
+        done(productHandler_->shed(admission));
+        return;
+    }
+    queueDepth_.inc();
+
+    boost::asio::post(*blockingPool_,
+        [this, &req, admission, done = std::move(done),
+         enqueued = std::chrono::steady_clock::now()] {
+            queued_.fetch_sub(1, std::memory_order_acq_rel);
+            queueDepth_.dec();
+            queueWait_.observe(std::chrono::steady_clock::now() - enqueued);
+            done(run(req, admission));
+        });
+}
+
+RequestHandler::Response
+RequestHandler::run(const http::request<http::string_body>& req,
+                    const ProductHandler::Admission& admission) {
+    try {
+        return productHandler_->handleAdmitted(req, admission);
+    } catch (const std::exception& e) {
+        // Nothing above this frame would answer the client, and on an I/O
+        // thread the exception would end io_context::run
+        utils::Logger::error("Unhandled error in request handler: {}", e.what());
+        return productHandler_->createErrorResponse(500, "Internal Server Error");
+    }
+}
+
 } // namespace adapters
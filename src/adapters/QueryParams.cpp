@@ -0,0 +1,115 @@
+#include "adapters/QueryParams.h"
+
+namespace adapters {
+
+namespace {
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+QueryParams::QueryParams(std::string_view target) {
+    std::string_view query = target;
+    auto queryPos = target.find('?');
+    if (queryPos != std::string_view::npos) {
+        query = target.substr(queryPos + 1);
+    } else if (!target.empty() && target.front() == '/') {
+        query = {};
+    }
+
+    // Fragments are never sent by clients, but ignore one if present
+    query = query.substr(0, query.find('#'));
+
+    std::size_t pos = 0;
+    while (pos <= query.size() && count_ < kMaxParams) {
+        auto end = query.find('&', pos);
+        if (end == std::string_view::npos) {
+            end = query.size();
+        }
+        auto pair = query.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (pair.empty()) {
+            continue;
+        }
+
+        auto eq = pair.find('=');
+        auto name = decode(pair.substr(0, eq), query.size());
+        auto value = eq == std::string_view::npos
+            ? std::string_view{}
+            : decode(pair.substr(eq + 1), query.size());
+        params_[count_++] = {name, value};
+    }
+}
+
+std::string_view QueryParams::get(std::string_view name) const {
+    for (std::size_t i = 0; i < count_; ++i) {
+        if (params_[i].first == name) {
+            return params_[i].second;
+        }
+    }
+    return {};
+}
+
+bool QueryParams::has(std::string_view name) const {
+    for (std::size_t i = 0; i < count_; ++i) {
+        if (params_[i].first == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view QueryParams::decode(std::string_view component, std::size_t capacity) {
+    if (component.find_first_of("%+") == std::string_view::npos) {
+        return component;
+    }
+
+    // Decoding never grows a component, so reserving the query length
+    // once guarantees earlier views into decoded_ are never invalidated
+    if (decoded_.capacity() < capacity) {
+        decoded_.reserve(capacity);
+    }
+
+    auto start = decoded_.size();
+    for (std::size_t i = 0; i < component.size(); ++i) {
+        char c = component[i];
+        if (c == '+') {
+            decoded_.push_back(' ');
+        } else if (c == '%' && i + 2 < component.size() &&
+                   hexValue(component[i + 1]) >= 0 && hexValue(component[i + 2]) >= 0) {
+            decoded_.push_back(static_cast<char>(hexValue(component[i + 1]) * 16 +
+                                                 hexValue(component[i + 2])));
+            i += 2;
+        } else {
+            decoded_.push_back(c);
+        }
+    }
+    return std::string_view(decoded_.data() + start, decoded_.size() - start);
+}
+
+std::string QueryParams::encode(std::string_view value) {
+    static constexpr char kHex[] = "0123456789ABCDEF";
+    std::string encoded;
+    encoded.reserve(value.size());
+    for (char c : value) {
+        auto byte = static_cast<unsigned char>(c);
+        bool unreserved = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+                          (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~';
+        if (unreserved) {
+            encoded.push_back(c);
+        } else {
+            encoded.push_back('%');
+            encoded.push_back(kHex[byte >> 4]);
+            encoded.push_back(kHex[byte & 0x0F]);
+        }
+    }
+    return encoded;
+}
+
+} // namespace adapters
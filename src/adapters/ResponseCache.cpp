@@ -0,0 +1,115 @@
+#include "adapters/ResponseCache.h"
+#include <functional>
+
+namespace adapters {
+
+namespace {
+
+std::size_t entryBytes(const std::string& key, const CachedResponse& response) {
+    std::size_t bytes = key.size() + response.body.size() + response.gzipBody.size() +
+                        response.etag.size();
+    for (const auto& [name, value] : response.headers) {
+        bytes += name.size() + value.size();
+    }
+    return bytes;
+}
+
+} // namespace
+
+ResponseCache::ResponseCache(ResponseCacheOptions options,
+                             std::shared_ptr<const domain::CatalogGenerations> generations)
+    : options_(options),
+      generations_(std::move(generations)),
+      shards_(options.shards > 0 ? options.shards : 1),
+      shardBudget_(options.maxBytes / shards_.size()) {}
+
+ResponseCache::Stamp ResponseCache::stamp(const std::string& category) const {
+    return generations_->current(category);
+}
+
+std::shared_ptr<const CachedResponse> ResponseCache::get(const std::string& key,
+                                                         const std::string& category) {
+    auto current = generations_->current(category);
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto entry = it->second;
+    if (entry->stamp != current || entry->expiresAt <= Clock::now()) {
+        if (entry->stamp != current) {
+            stale_.fetch_add(1, std::memory_order_relaxed);
+        }
+        erase(shard, entry);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return entry->response;
+}
+
+void ResponseCache::put(const std::string& key, const Stamp& stamp, CachedResponse response) {
+    if (options_.compression.enabled && response.body.size() >= options_.compression.minSize) {
+        response.gzipBody = utils::Compressor::compress(utils::ContentEncoding::Gzip,
+                                                        options_.compression.level, response.body);
+        if (response.gzipBody.size() >= response.body.size()) {
+            response.gzipBody.clear();
+        }
+    }
+
+    auto bytes = entryBytes(key, response);
+    if (bytes > shardBudget_) {
+        return;
+    }
+
+    auto shared = std::make_shared<const CachedResponse>(std::move(response));
+    auto expiresAt = Clock::now() + options_.ttl;
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        erase(shard, it->second);
+    }
+
+    shard.entries.push_front(Entry{key, std::move(shared), stamp, expiresAt, bytes});
+    shard.index.emplace(key, shard.entries.begin());
+    shard.bytes += bytes;
+
+    while (shard.bytes > shardBudget_) {
+        erase(shard, std::prev(shard.entries.end()));
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+ResponseCacheStats ResponseCache::stats() const {
+    ResponseCacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.stale = stale_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.entries.size();
+        stats.bytes += shard.bytes;
+    }
+    return stats;
+}
+
+ResponseCache::Shard& ResponseCache::shardFor(const std::string& key) {
+    return shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+void ResponseCache::erase(Shard& shard, std::list<Entry>::iterator it) {
+    shard.bytes -= it->bytes;
+    shard.index.erase(it->key);
+    shard.entries.erase(it);
+}
+
+} // namespace adapters
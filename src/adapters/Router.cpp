@@ -0,0 +1,93 @@
+#include "adapters/Router.h"
+#include "utils/ObjectId.h"
+#include <stdexcept>
+
+namespace adapters {
+
+namespace {
+
+// Yields the next '/'-separated segment of path starting at pos
+bool nextSegment(std::string_view path, std::size_t& pos, std::string_view& segment) {
+    while (pos < path.size() && path[pos] == '/') {
+        ++pos;
+    }
+    if (pos >= path.size()) {
+        return false;
+    }
+    auto end = path.find('/', pos);
+    if (end == std::string_view::npos) {
+        end = path.size();
+    }
+    segment = path.substr(pos, end - pos);
+    pos = end;
+    return true;
+}
+
+} // namespace
+
+void Router::add(http::verb method, std::string_view pattern, Handler handler) {
+    Entry entry{Route{method, std::string(pattern), std::move(handler), entries_.size()}, {}};
+
+    std::size_t pos = 0;
+    std::string_view segment;
+    while (nextSegment(pattern, pos, segment)) {
+        if (segment.size() >= 2 && segment.front() == '{' && segment.back() == '}') {
+            auto spec = segment.substr(1, segment.size() - 2);
+            auto colon = spec.find(':');
+            auto name = spec.substr(0, colon);
+            if (colon == std::string_view::npos) {
+                entry.segments.push_back({SegmentKind::Param, std::string(name)});
+            } else if (spec.substr(colon + 1) == "oid") {
+                entry.segments.push_back({SegmentKind::ObjectIdParam, std::string(name)});
+            } else {
+                throw std::invalid_argument("Unknown route parameter type in " + std::string(pattern));
+            }
+        } else {
+            entry.segments.push_back({SegmentKind::Literal, std::string(segment)});
+        }
+    }
+
+    entries_.push_back(std::move(entry));
+}
+
+const Router::Route* 
+Router::match(http::verb method, std::string_view path, RouteParams& params) const {
+    for (const auto& entry : entries_) {
+        if (entry.route.method != method) {
+            continue;
+        }
+
+        params.clear();
+        std::size_t pos = 0;
+        std::string_view segment;
+        bool matched = true;
+
+        for (const auto& expected : entry.segments) {
+            if (!nextSegment(path, pos, segment)) {
+                matched = false;
+                break;
+            }
+            if (expected.kind == SegmentKind::Literal) {
+                matched = segment == expected.text;
+            } else if (expected.kind == SegmentKind::ObjectIdParam) {
+                matched = utils::ObjectId::isValid(segment);
+            }
+            if (!matched) {
+                break;
+            }
+            if (expected.kind != SegmentKind::Literal) {
+                params.add(expected.text, segment);
+            }
+        }
+
+        // The whole path must be consumed
+        if (matched && !nextSegment(path, pos, segment)) {
+            return &entry.route;
+        }
+    }
+
+    params.clear();
+    return nullptr;
+}
+
+} // namespace adapters
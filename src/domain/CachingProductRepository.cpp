@@ -0,0 +1,289 @@
+#include "domain/CachingProductRepository.h"
+#include "utils/Logger.h"
+#include "utils/ObjectId.h"
+#include <functional>
+
+namespace domain {
+
+CachingProductRepository::CachingProductRepository(std::shared_ptr<ProductRepository> inner,
+                                                   ProductCacheOptions options,
+                                                   std::shared_ptr<CatalogGenerations> generations)
+    : inner_(std::move(inner)),
+      options_(options),
+      products_(options.productCapacity, options.shards),
+      lists_(options.listCapacity, options.shards),
+      generations_(generations ? std::move(generations)
+                               : std::make_shared<CatalogGenerations>()) {}
+
+std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>> 
+CachingProductRepository::findAll(const std::string& category) {
+    auto key = listKey(category, "*");
+    if (auto cached = lists_.get(key)) {
+        return {(*cached)->items, std::nullopt};
+    }
+
+    auto [products, error] = inner_->findAll(category);
+    if (!error) {
+        lists_.put(key, std::make_shared<const ProductPage>(ProductPage{products, ""}), options_.ttl);
+    }
+    return {std::move(products), error};
+}
+
+std::pair<ProductPage, std::optional<utils::AppError>>
+CachingProductRepository::findPage(const std::string& category, const std::string& afterId,
+                                   std::size_t limit) {
+    auto key = listKey(category, afterId + "/" + std::to_string(limit));
+    if (auto cached = lists_.get(key)) {
+        return {**cached, std::nullopt};
+    }
+
+    auto [page, error] = inner_->findPage(category, afterId, limit);
+    if (!error) {
+        lists_.put(key, std::make_shared<const ProductPage>(page), options_.ttl);
+    }
+    return {std::move(page), error};
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>> 
+CachingProductRepository::findById(const std::string& id) {
+    auto key = utils::ObjectId::normalize(id);
+    if (auto cached = products_.get(key)) {
+        if (*cached) {
+            return {std::move(*cached), std::nullopt};
+        }
+        return {nullptr, utils::AppError::notFound("Product not found")};
+    }
+
+    auto version = versionOf(key).load();
+    auto [product, error] = inner_->findById(id);
+    if (!error && product) {
+        putProduct(key, product, version);
+    } else if (error && error->getCode() == utils::AppError::ErrorCode::NOT_FOUND) {
+        putProduct(key, nullptr, version);
+    }
+    return {std::move(product), error};
+}
+
+std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+CachingProductRepository::findByIds(const std::vector<std::string>& ids) {
+    // Serve what the per-id cache knows; fetch the rest in one call
+    std::vector<ProductPtr> slots(ids.size());
+    std::vector<std::string> keys;
+    std::vector<std::string> misses;
+    std::vector<std::uint64_t> versions;
+    keys.reserve(ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        keys.push_back(utils::ObjectId::normalize(ids[i]));
+        if (auto cached = products_.get(keys[i])) {
+            slots[i] = std::move(*cached);
+        } else {
+            misses.push_back(keys[i]);
+            versions.push_back(versionOf(keys[i]).load());
+        }
+    }
+
+    if (!misses.empty()) {
+        auto [fetched, error] = inner_->findByIds(misses);
+        if (error) {
+            return {{}, error};
+        }
+
+        std::unordered_map<std::string_view, ProductPtr> byId;
+        byId.reserve(fetched.size());
+        for (auto& product : fetched) {
+            byId.emplace(product->getId(), std::move(product));
+        }
+
+        for (std::size_t i = 0; i < misses.size(); ++i) {
+            auto it = byId.find(misses[i]);
+            putProduct(misses[i], it != byId.end() ? it->second : nullptr, versions[i]);
+        }
+
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            if (slots[i]) {
+                continue;
+            }
+            auto it = byId.find(keys[i]);
+            if (it != byId.end()) {
+                slots[i] = it->second;
+            }
+        }
+    }
+
+    std::vector<ProductPtr> products;
+    products.reserve(ids.size());
+    for (auto& slot : slots) {
+        if (slot) {
+            products.push_back(std::move(slot));
+        }
+    }
+    return {std::move(products), std::nullopt};
+}
+
+std::pair<std::string, std::optional<utils::AppError>> 
+CachingProductRepository::create(const Product& product) {
+    auto result = inner_->create(product);
+    if (!result.second) {
+        // A new product only changes the lists it is about to appear in.
+        // The erase drops a "not found" entry a racing read may have cached.
+        eraseProduct(result.first);
+        invalidateCategory("");
+        invalidateCategory(product.getCategory());
+    }
+    return result;
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+CachingProductRepository::update(const Product& product) {
+    auto result = inner_->update(product);
+    invalidateProduct(product.getId(), product.getCategory());
+    return result;
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+CachingProductRepository::patch(const std::string& id, const ProductPatch& patch) {
+    auto result = inner_->patch(id, patch);
+    // Without a stored product the new category is unknown
+    invalidateProduct(id, result.first ? result.first->getCategory() : "");
+    return result;
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+CachingProductRepository::reserveStock(const std::string& id, int quantity) {
+    auto result = inner_->reserveStock(id, quantity);
+    invalidateStockChange(id, result);
+    return result;
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+CachingProductRepository::releaseStock(const std::string& id, int quantity) {
+    auto result = inner_->releaseStock(id, quantity);
+    invalidateStockChange(id, result);
+    return result;
+}
+
+std::optional<utils::AppError> 
+CachingProductRepository::deleteById(const std::string& id) {
+    auto error = inner_->deleteById(id);
+    invalidateProduct(id, "");
+    return error;
+}
+
+std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+CachingProductRepository::bulkWrite(const std::vector<BulkOperation>& operations) {
+    auto result = inner_->bulkWrite(operations);
+    if (result.second) {
+        // The batch may have partially applied before failing
+        for (const auto& op : operations) {
+            if (!op.id.empty()) {
+                eraseProduct(utils::ObjectId::normalize(op.id));
+            }
+        }
+        invalidateAllLists();
+        return result;
+    }
+
+    const auto& items = result.first;
+    for (std::size_t i = 0; i < operations.size() && i < items.size(); ++i) {
+        const auto& op = operations[i];
+        switch (op.type) {
+            case BulkOperation::Type::Create:
+                if (!items[i].error) {
+                    eraseProduct(items[i].id);
+                    invalidateCategory("");
+                    invalidateCategory(op.product.getCategory());
+                }
+                break;
+            case BulkOperation::Type::Update:
+                invalidateProduct(op.id, op.product.getCategory());
+                break;
+            case BulkOperation::Type::Delete:
+                invalidateProduct(op.id, "");
+                break;
+        }
+    }
+    return result;
+}
+
+bool CachingProductRepository::exists(const std::string& id) {
+    if (auto cached = products_.get(utils::ObjectId::normalize(id))) {
+        return *cached != nullptr;
+    }
+    return inner_->exists(id);
+}
+
+std::atomic<std::uint64_t>& CachingProductRepository::versionOf(const std::string& key) {
+    return versions_[std::hash<std::string>{}(key) % kVersionStripes];
+}
+
+void CachingProductRepository::putProduct(const std::string& key, ProductPtr product,
+                                          std::uint64_t version) {
+    auto& current = versionOf(key);
+    if (current.load() != version) {
+        return;
+    }
+    auto ttl = product ? options_.ttl : options_.negativeTtl;
+    products_.put(key, std::move(product), ttl);
+    // A write that bumped the version after the check has erased the key
+    // already, possibly before this put; take the stale entry back out
+    if (current.load() != version) {
+        products_.erase(key);
+    }
+}
+
+void CachingProductRepository::eraseProduct(const std::string& key) {
+    versionOf(key).fetch_add(1);
+    products_.erase(key);
+}
+
+std::string CachingProductRepository::listKey(const std::string& category,
+                                             const std::string& suffix) const {
+    auto stamp = generations_->current(category);
+    return std::to_string(stamp.epoch) + "." + std::to_string(stamp.generation) + "|" +
+           category + "|" + suffix;
+}
+
+void CachingProductRepository::invalidateCategory(const std::string& category) {
+    generations_->bump(category);
+}
+
+void CachingProductRepository::invalidateAllLists() {
+    generations_->bumpAll();
+}
+
+void CachingProductRepository::invalidateProduct(const std::string& id,
+                                                 const std::string& category) {
+    // The product may be leaving the category it was cached under. When
+    // that category is unknown, every cached list is suspect.
+    auto key = utils::ObjectId::normalize(id);
+    auto previous = products_.peek(key);
+    eraseProduct(key);
+
+    if (!previous) {
+        invalidateAllLists();
+        return;
+    }
+
+    invalidateCategory("");
+    if (!category.empty()) {
+        invalidateCategory(category);
+    }
+    if (*previous && (*previous)->getCategory() != category) {
+        invalidateCategory((*previous)->getCategory());
+    }
+}
+
+void CachingProductRepository::invalidateStockChange(
+    const std::string& id,
+    const std::pair<ProductPtr, std::optional<utils::AppError>>& result) {
+    // Refused reservations leave the store as it was; under contention
+    // they are the common case and must not flush the cache
+    if (result.first) {
+        invalidateProduct(id, result.first->getCategory());
+    } else if (result.second &&
+               result.second->getCode() == utils::AppError::ErrorCode::INTERNAL_ERROR) {
+        invalidateProduct(id, "");
+    }
+}
+
+} // namespace domain
@@ -0,0 +1,394 @@
+#include "domain/InMemoryProductRepository.h"
+#include "utils/Logger.h"
+#include "utils/ObjectId.h"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+
+namespace domain {
+
+namespace {
+
+utils::AppError databaseError() {
+    return utils::AppError::internalError("Database error occurred");
+}
+
+} // namespace
+
+InMemoryProductRepository::InMemoryProductRepository(
+    std::size_t shardCount, std::shared_ptr<CatalogGenerations> generations)
+    : generations_(std::move(generations)) {
+    shards_.reserve(shardCount > 0 ? shardCount : 1);
+    for (std::size_t i = 0; i < shards_.capacity(); ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+    utils::Logger::info("Using in-memory product repository ({} shards)", shards_.size());
+}
+
+std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+InMemoryProductRepository::findAll(const std::string& category) {
+    auto products = ordered(category, "", 0);
+    utils::Logger::debug("Found {} products", products.size());
+    return {std::move(products), std::nullopt};
+}
+
+std::pair<ProductPage, std::optional<utils::AppError>>
+InMemoryProductRepository::findPage(const std::string& category, const std::string& afterId,
+                                    std::size_t limit) {
+    if (!afterId.empty() && !utils::ObjectId::isValid(afterId)) {
+        return {{}, databaseError()};
+    }
+
+    // One extra product tells whether another page follows
+    ProductPage page;
+    page.items = ordered(category, utils::ObjectId::normalize(afterId), limit + 1);
+    bool hasMore = page.items.size() > limit;
+    if (hasMore) {
+        page.items.pop_back();
+    }
+
+    if (hasMore && !page.items.empty()) {
+        page.nextCursor = page.items.back()->getId();
+    }
+    return {std::move(page), std::nullopt};
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InMemoryProductRepository::findById(const std::string& id) {
+    if (!utils::ObjectId::isValid(id)) {
+        return {nullptr, databaseError()};
+    }
+
+    if (auto product = get(utils::ObjectId::normalize(id))) {
+        return {std::move(product), std::nullopt};
+    }
+    return {nullptr, utils::AppError::notFound("Product not found")};
+}
+
+std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+InMemoryProductRepository::findByIds(const std::vector<std::string>& ids) {
+    std::vector<ProductPtr> products;
+    products.reserve(ids.size());
+    for (const auto& id : ids) {
+        if (!utils::ObjectId::isValid(id)) {
+            return {{}, databaseError()};
+        }
+        if (auto product = get(utils::ObjectId::normalize(id))) {
+            products.push_back(std::move(product));
+        }
+    }
+    return {std::move(products), std::nullopt};
+}
+
+std::pair<std::string, std::optional<utils::AppError>>
+InMemoryProductRepository::create(const Product& product) {
+    auto id = utils::ObjectId::generate();
+    auto stored = std::make_shared<Product>(product);
+    stored->setId(id);
+
+    auto& shard = shardFor(id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.products.emplace(id, std::move(stored));
+    indexInsert(shard, id, product.getCategory());
+    changed(product.getCategory(), product.getCategory());
+
+    utils::Logger::debug("Created product with ID: {}", id);
+    return {id, std::nullopt};
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InMemoryProductRepository::update(const Product& product) {
+    return modify(product.getId(), [&product](Product& stored) {
+        stored.setName(product.getName());
+        stored.setDescription(product.getDescription());
+        stored.setPrice(product.getPrice());
+        stored.setStock(product.getStock());
+        stored.setCategory(product.getCategory());
+        return std::optional<utils::AppError>{};
+    });
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InMemoryProductRepository::patch(const std::string& id, const ProductPatch& patch) {
+    return modify(id, [&patch](Product& stored) {
+        if (patch.name) {
+            stored.setName(*patch.name);
+        }
+        if (patch.description) {
+            stored.setDescription(*patch.description);
+        }
+        if (patch.price) {
+            stored.setPrice(*patch.price);
+        }
+        if (patch.stock) {
+            stored.setStock(*patch.stock);
+        }
+        if (patch.category) {
+            stored.setCategory(*patch.category);
+        }
+        return std::optional<utils::AppError>{};
+    });
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InMemoryProductRepository::reserveStock(const std::string& id, int quantity) {
+    return modify(id, [quantity](Product& stored) -> std::optional<utils::AppError> {
+        if (!stored.canFulfillOrder(quantity)) {
+            return utils::AppError::conflict("Insufficient stock");
+        }
+        stored.reduceStock(quantity);
+        return std::nullopt;
+    });
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InMemoryProductRepository::releaseStock(const std::string& id, int quantity) {
+    return modify(id, [quantity](Product& stored) {
+        stored.increaseStock(quantity);
+        return std::optional<utils::AppError>{};
+    });
+}
+
+std::optional<utils::AppError>
+InMemoryProductRepository::deleteById(const std::string& id) {
+    if (!utils::ObjectId::isValid(id)) {
+        return databaseError();
+    }
+
+    auto key = utils::ObjectId::normalize(id);
+    auto& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.products.find(key);
+    if (it == shard.products.end()) {
+        return utils::AppError::notFound("Product not found");
+    }
+
+    indexErase(shard, key, it->second->getCategory());
+    changed(it->second->getCategory(), it->second->getCategory());
+    shard.products.erase(it);
+
+    utils::Logger::debug("Deleted product: {}", key);
+    return std::nullopt;
+}
+
+std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+InMemoryProductRepository::bulkWrite(const std::vector<BulkOperation>& operations) {
+    // A malformed target fails the whole batch, as it does before Mongo sees it
+    for (const auto& op : operations) {
+        if (op.type != BulkOperation::Type::Create && !utils::ObjectId::isValid(op.id)) {
+            return {{}, databaseError()};
+        }
+    }
+
+    std::vector<BulkItemResult> results(operations.size());
+    for (std::size_t i = 0; i < operations.size(); ++i) {
+        const auto& op = operations[i];
+        auto& result = results[i];
+
+        switch (op.type) {
+            case BulkOperation::Type::Create:
+                result.id = create(op.product).first;
+                break;
+            case BulkOperation::Type::Update: {
+                Product product = op.product;
+                product.setId(op.id);
+                result.id = op.id;
+                result.error = update(product).second;
+                break;
+            }
+            case BulkOperation::Type::Delete:
+                result.id = op.id;
+                result.error = deleteById(op.id);
+                break;
+        }
+    }
+
+    utils::Logger::debug("Bulk write of {} operations", operations.size());
+    return {std::move(results), std::nullopt};
+}
+
+bool InMemoryProductRepository::exists(const std::string& id) {
+    return utils::ObjectId::isValid(id) && get(utils::ObjectId::normalize(id)) != nullptr;
+}
+
+void InMemoryProductRepository::put(ProductPtr product) {
+    auto id = utils::ObjectId::normalize(product->getId());
+    if (id != product->getId()) {
+        auto normalized = std::make_shared<Product>(*product);
+        normalized->setId(id);
+        product = std::move(normalized);
+    }
+    const auto& category = product->getCategory();
+
+    auto& shard = shardFor(id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.products.find(id);
+    if (it == shard.products.end()) {
+        shard.products.emplace(id, std::move(product));
+        indexInsert(shard, id, category);
+        changed(category, category);
+        return;
+    }
+
+    // Before the swap: previousCategory lives in the snapshot it replaces
+    const auto& previousCategory = it->second->getCategory();
+    if (previousCategory != category) {
+        indexMove(shard, id, previousCategory, category);
+    }
+    changed(previousCategory, category);
+    it->second = std::move(product);
+}
+
+std::size_t InMemoryProductRepository::size() const {
+    std::size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        total += shard->products.size();
+    }
+    return total;
+}
+
+InMemoryProductRepository::Shard&
+InMemoryProductRepository::shardFor(const std::string& id) const {
+    return *shards_[std::hash<std::string>{}(id) % shards_.size()];
+}
+
+std::vector<ProductPtr>
+InMemoryProductRepository::ordered(const std::string& category, const std::string& afterId,
+                                   std::size_t limit) const {
+    struct Cursor {
+        std::set<std::string>::const_iterator next;
+        std::set<std::string>::const_iterator end;
+        const Shard* shard;
+    };
+
+    std::vector<std::shared_lock<std::shared_mutex>> locks;
+    std::vector<Cursor> cursors;
+    locks.reserve(shards_.size());
+    cursors.reserve(shards_.size());
+    for (const auto& shard : shards_) {
+        locks.emplace_back(shard->mutex);
+
+        const std::set<std::string>* index = &shard->ids;
+        if (!category.empty()) {
+            auto it = shard->byCategory.find(category);
+            if (it == shard->byCategory.end()) {
+                continue;
+            }
+            index = &it->second;
+        }
+        auto next = afterId.empty() ? index->begin() : index->upper_bound(afterId);
+        if (next != index->end()) {
+            cursors.push_back(Cursor{next, index->end(), shard.get()});
+        }
+    }
+
+    // Min-heap on each shard's next id
+    auto later = [](const Cursor& a, const Cursor& b) { return *a.next > *b.next; };
+    std::make_heap(cursors.begin(), cursors.end(), later);
+
+    std::vector<ProductPtr> products;
+    if (limit > 0) {
+        products.reserve(limit);
+    }
+    while (!cursors.empty() && (limit == 0 || products.size() < limit)) {
+        std::pop_heap(cursors.begin(), cursors.end(), later);
+        auto& cursor = cursors.back();
+        products.push_back(cursor.shard->products.at(*cursor.next));
+        if (++cursor.next == cursor.end) {
+            cursors.pop_back();
+        } else {
+            std::push_heap(cursors.begin(), cursors.end(), later);
+        }
+    }
+    return products;
+}
+
+ProductPtr InMemoryProductRepository::get(const std::string& id) const {
+    auto& shard = shardFor(id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.products.find(id);
+    if (it == shard.products.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+template <typename Change>
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InMemoryProductRepository::modify(const std::string& id, Change&& change) {
+    if (!utils::ObjectId::isValid(id)) {
+        return {nullptr, databaseError()};
+    }
+
+    auto key = utils::ObjectId::normalize(id);
+    auto& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.products.find(key);
+    if (it == shard.products.end()) {
+        return {nullptr, utils::AppError::notFound("Product not found")};
+    }
+
+    // Readers may still hold the current snapshot, so change a copy
+    auto next = std::make_shared<Product>(*it->second);
+    if (auto error = change(*next)) {
+        return {nullptr, error};
+    }
+
+    // Still under the shard lock, so concurrent updates of this id keep
+    // the shard's index in step with the stored category
+    const auto& previousCategory = it->second->getCategory();
+    if (previousCategory != next->getCategory()) {
+        indexMove(shard, key, previousCategory, next->getCategory());
+    }
+    changed(previousCategory, next->getCategory());
+    it->second = next;
+
+    utils::Logger::debug("Updated product: {}", key);
+    return {std::move(next), std::nullopt};
+}
+
+void InMemoryProductRepository::indexInsert(Shard& shard, const std::string& id,
+                                            const std::string& category) {
+    shard.ids.insert(id);
+    shard.byCategory[category].insert(id);
+}
+
+void InMemoryProductRepository::indexErase(Shard& shard, const std::string& id,
+                                           const std::string& category) {
+    shard.ids.erase(id);
+    eraseFromCategory(shard, id, category);
+}
+
+void InMemoryProductRepository::indexMove(Shard& shard, const std::string& id,
+                                          const std::string& from, const std::string& to) {
+    eraseFromCategory(shard, id, from);
+    shard.byCategory[to].insert(id);
+}
+
+void InMemoryProductRepository::changed(const std::string& from, const std::string& to) {
+    if (!generations_) {
+        return;
+    }
+    generations_->bumpProduct(from);
+    if (to != from) {
+        generations_->bump(to);
+    }
+}
+
+void InMemoryProductRepository::eraseFromCategory(Shard& shard, const std::string& id,
+                                                  const std::string& category) {
+    auto it = shard.byCategory.find(category);
+    if (it != shard.byCategory.end()) {
+        it->second.erase(id);
+        if (it->second.empty()) {
+            shard.byCategory.erase(it);
+        }
+    }
+}
+
+} // namespace domain
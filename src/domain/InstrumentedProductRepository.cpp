@@ -0,0 +1,118 @@
+#include "domain/InstrumentedProductRepository.h"
+#include <chrono>
+
+namespace domain {
+
+namespace {
+
+constexpr const char* kOperationNames[] = {
+    "findAll", "findPage", "findById", "findByIds", "create", "update", "patch",
+    "reserveStock", "releaseStock", "deleteById", "bulkWrite", "exists"};
+
+// Only store failures count as errors; not-found and conflicts are answers
+bool isDatabaseError(const std::optional<utils::AppError>& error) {
+    return error && error->getCode() == utils::AppError::ErrorCode::INTERNAL_ERROR;
+}
+
+template <typename T>
+bool isDatabaseError(const std::pair<T, std::optional<utils::AppError>>& result) {
+    return isDatabaseError(result.second);
+}
+
+bool isDatabaseError(bool) {
+    return false;
+}
+
+} // namespace
+
+InstrumentedProductRepository::InstrumentedProductRepository(std::shared_ptr<ProductRepository> inner,
+                                                             utils::MetricsRegistry& registry)
+    : inner_(std::move(inner)) {
+    for (std::size_t i = 0; i < kOperationCount; ++i) {
+        std::string labels = std::string("operation=\"") + kOperationNames[i] + "\"";
+        metrics_[i].latency = &registry.histogram(
+            "product_repository_operation_duration_seconds",
+            "Latency of ProductRepository calls", labels);
+        metrics_[i].errors = &registry.counter(
+            "product_repository_errors_total",
+            "ProductRepository calls that failed with a database error", labels);
+    }
+}
+
+template <typename Call>
+auto InstrumentedProductRepository::timed(Operation operation, Call&& call) {
+    auto start = std::chrono::steady_clock::now();
+    auto result = call();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto& metrics = metrics_[operation];
+    metrics.latency->observe(elapsed);
+    if (observer_) {
+        observer_(elapsed);
+    }
+    if (isDatabaseError(result)) {
+        metrics.errors->inc();
+    }
+    return result;
+}
+
+std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+InstrumentedProductRepository::findAll(const std::string& category) {
+    return timed(FindAll, [&] { return inner_->findAll(category); });
+}
+
+std::pair<ProductPage, std::optional<utils::AppError>>
+InstrumentedProductRepository::findPage(const std::string& category, const std::string& afterId,
+                                        std::size_t limit) {
+    return timed(FindPage, [&] { return inner_->findPage(category, afterId, limit); });
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InstrumentedProductRepository::findById(const std::string& id) {
+    return timed(FindById, [&] { return inner_->findById(id); });
+}
+
+std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+InstrumentedProductRepository::findByIds(const std::vector<std::string>& ids) {
+    return timed(FindByIds, [&] { return inner_->findByIds(ids); });
+}
+
+std::pair<std::string, std::optional<utils::AppError>>
+InstrumentedProductRepository::create(const Product& product) {
+    return timed(Create, [&] { return inner_->create(product); });
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InstrumentedProductRepository::update(const Product& product) {
+    return timed(Update, [&] { return inner_->update(product); });
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InstrumentedProductRepository::patch(const std::string& id, const ProductPatch& patch) {
+    return timed(Patch, [&] { return inner_->patch(id, patch); });
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InstrumentedProductRepository::reserveStock(const std::string& id, int quantity) {
+    return timed(ReserveStock, [&] { return inner_->reserveStock(id, quantity); });
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+InstrumentedProductRepository::releaseStock(const std::string& id, int quantity) {
+    return timed(ReleaseStock, [&] { return inner_->releaseStock(id, quantity); });
+}
+
+std::optional<utils::AppError>
+InstrumentedProductRepository::deleteById(const std::string& id) {
+    return timed(DeleteById, [&] { return inner_->deleteById(id); });
+}
+
+std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+InstrumentedProductRepository::bulkWrite(const std::vector<BulkOperation>& operations) {
+    return timed(BulkWrite, [&] { return inner_->bulkWrite(operations); });
+}
+
+bool InstrumentedProductRepository::exists(const std::string& id) {
+    return timed(Exists, [&] { return inner_->exists(id); });
+}
+
+} // namespace domain
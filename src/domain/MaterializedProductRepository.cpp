@@ -0,0 +1,291 @@
+#include "domain/MaterializedProductRepository.h"
+#include "domain/ProductRepositoryMongo.h"
+#include "utils/Logger.h"
+#include <bsoncxx/json.hpp>
+#include <mongocxx/change_stream.hpp>
+#include <mongocxx/exception/exception.hpp>
+#include <mongocxx/exception/operation_exception.hpp>
+#include <mongocxx/options/change_stream.hpp>
+#include <mongocxx/uri.hpp>
+#include <algorithm>
+
+namespace domain {
+
+namespace {
+
+// Upper bound on one wait for new events, so stop() is noticed promptly
+constexpr std::chrono::milliseconds kMaxAwait{500};
+constexpr std::chrono::milliseconds kInitialBackoff{500};
+constexpr std::chrono::milliseconds kMaxBackoff{30000};
+
+// Server errors after which a resume token cannot be used again
+constexpr int kChangeStreamFatalError = 280;
+constexpr int kChangeStreamHistoryLost = 286;
+// $changeStream on a standalone server
+constexpr int kNotReplicaSet = 40573;
+
+double secondsSinceEpoch() {
+    return std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+MaterializedProductRepository::MaterializedProductRepository(
+    const std::string& connectionString, const std::string& databaseName,
+    std::shared_ptr<ProductRepository> writes, std::size_t shardCount,
+    std::shared_ptr<CatalogGenerations> generations)
+    : writes_(std::move(writes)),
+      databaseName_(databaseName),
+      shardCount_(shardCount),
+      generations_(std::move(generations)),
+      client_(mongocxx::uri{connectionString}),
+      store_(std::make_shared<InMemoryProductRepository>(shardCount, generations_)) {}
+
+MaterializedProductRepository::~MaterializedProductRepository() {
+    stop();
+}
+
+void MaterializedProductRepository::start() {
+    if (follower_.joinable()) {
+        return;
+    }
+    stopping_ = false;
+    follower_ = std::thread([this] { follow(); });
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return loaded_ || stopping_; });
+}
+
+void MaterializedProductRepository::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    if (follower_.joinable()) {
+        follower_.join();
+    }
+}
+
+std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+MaterializedProductRepository::findAll(const std::string& category) {
+    return store()->findAll(category);
+}
+
+std::pair<ProductPage, std::optional<utils::AppError>>
+MaterializedProductRepository::findPage(const std::string& category, const std::string& afterId,
+                                        std::size_t limit) {
+    return store()->findPage(category, afterId, limit);
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+MaterializedProductRepository::findById(const std::string& id) {
+    return store()->findById(id);
+}
+
+std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+MaterializedProductRepository::findByIds(const std::vector<std::string>& ids) {
+    return store()->findByIds(ids);
+}
+
+std::pair<std::string, std::optional<utils::AppError>>
+MaterializedProductRepository::create(const Product& product) {
+    return writes_->create(product);
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+MaterializedProductRepository::update(const Product& product) {
+    return writes_->update(product);
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+MaterializedProductRepository::patch(const std::string& id, const ProductPatch& patch) {
+    return writes_->patch(id, patch);
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+MaterializedProductRepository::reserveStock(const std::string& id, int quantity) {
+    return writes_->reserveStock(id, quantity);
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+MaterializedProductRepository::releaseStock(const std::string& id, int quantity) {
+    return writes_->releaseStock(id, quantity);
+}
+
+std::optional<utils::AppError>
+MaterializedProductRepository::deleteById(const std::string& id) {
+    return writes_->deleteById(id);
+}
+
+std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+MaterializedProductRepository::bulkWrite(const std::vector<BulkOperation>& operations) {
+    return writes_->bulkWrite(operations);
+}
+
+bool MaterializedProductRepository::exists(const std::string& id) {
+    return store()->exists(id);
+}
+
+MaterializedCatalogStats MaterializedProductRepository::getStats() const {
+    auto current = store();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto stats = stats_;
+    stats.products = current->size();
+    return stats;
+}
+
+std::shared_ptr<InMemoryProductRepository> MaterializedProductRepository::store() const {
+    return std::atomic_load(&store_);
+}
+
+void MaterializedProductRepository::follow() {
+    auto backoff = kInitialBackoff;
+
+    while (!stopping_) {
+        try {
+            auto collection = client_[databaseName_]["products"];
+
+            mongocxx::options::change_stream options;
+            options.full_document("updateLookup");
+            options.max_await_time(kMaxAwait);
+            if (resumeToken_) {
+                options.resume_after(resumeToken_->view());
+                utils::Logger::info("Resuming change stream after {}",
+                                    bsoncxx::to_json(resumeToken_->view()));
+            }
+
+            // Opened before any scan, so changes made during the scan are
+            // replayed on top of it; applying an event twice is harmless
+            auto stream = collection.watch(options);
+            if (!resumeToken_) {
+                if (auto token = stream.get_resume_token()) {
+                    rememberResumeToken(*token);
+                }
+                resync(collection);
+            }
+
+            setStreaming(true);
+            backoff = kInitialBackoff;
+
+            bool resumable = true;
+            while (!stopping_ && resumable) {
+                auto current = store();
+                for (const auto& event : stream) {
+                    if (!apply(event, *current)) {
+                        resumable = false;
+                        break;
+                    }
+                    rememberResumeToken(event["_id"].get_document().value);
+                }
+                // The post-batch token moves on even when no product changed,
+                // keeping the resume point inside the oplog window
+                if (resumable) {
+                    if (auto token = stream.get_resume_token()) {
+                        rememberResumeToken(*token);
+                    }
+                }
+            }
+
+            if (!resumable) {
+                utils::Logger::warn("Products collection was dropped or renamed; reloading catalog");
+                resumeToken_.reset();
+            }
+        } catch (const mongocxx::operation_exception& e) {
+            auto code = e.code().value();
+            if (code == kChangeStreamHistoryLost || code == kChangeStreamFatalError) {
+                utils::Logger::warn("Change stream cannot resume ({}); reloading catalog", e.what());
+                resumeToken_.reset();
+            } else if (code == kNotReplicaSet) {
+                utils::Logger::error("Change streams need a replica set: {}", e.what());
+            } else {
+                utils::Logger::error("Change stream error: {}", e.what());
+            }
+        } catch (const std::exception& e) {
+            utils::Logger::error("Change stream error: {}", e.what());
+        }
+
+        setStreaming(false);
+        if (stopping_) {
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.reconnects;
+        }
+        pause(backoff);
+        backoff = std::min(backoff * 2, kMaxBackoff);
+    }
+}
+
+void MaterializedProductRepository::resync(mongocxx::collection& collection) {
+    auto fresh = std::make_shared<InMemoryProductRepository>(shardCount_, generations_);
+    for (const auto& doc : collection.find({})) {
+        fresh->put(ProductRepositoryMongo::documentToProduct(doc));
+    }
+    std::atomic_store(&store_, fresh);
+    if (generations_) {
+        generations_->bumpAll();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.resyncs;
+        loaded_ = true;
+    }
+    changed_.notify_all();
+    utils::Logger::info("Materialized catalog loaded: {} products", fresh->size());
+}
+
+bool MaterializedProductRepository::apply(const bsoncxx::document::view& event,
+                                          InMemoryProductRepository& store) {
+    auto operation = event["operationType"].get_string().value;
+
+    if (operation == "insert" || operation == "update" || operation == "replace") {
+        auto document = event["fullDocument"];
+        if (document && document.type() == bsoncxx::type::k_document) {
+            store.put(ProductRepositoryMongo::documentToProduct(document.get_document().value));
+        } else {
+            // Deleted again before the update lookup ran
+            store.deleteById(event["documentKey"]["_id"].get_oid().value.to_string());
+        }
+    } else if (operation == "delete") {
+        store.deleteById(event["documentKey"]["_id"].get_oid().value.to_string());
+    } else if (operation == "drop" || operation == "rename" || operation == "dropDatabase" ||
+               operation == "invalidate") {
+        return false;
+    }
+
+    auto clusterTime = event["clusterTime"].get_timestamp().timestamp;
+    // wallTime (MongoDB 6.0+) has millisecond precision; clusterTime only seconds
+    double committed = clusterTime;
+    if (auto wallTime = event["wallTime"]) {
+        committed = static_cast<double>(wallTime.get_date().value.count()) / 1000.0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.eventsApplied;
+    stats_.resumeClusterTime = clusterTime;
+    stats_.lagSeconds = std::max(0.0, secondsSinceEpoch() - committed);
+    return true;
+}
+
+void MaterializedProductRepository::rememberResumeToken(const bsoncxx::document::view& token) {
+    resumeToken_.emplace(token);
+    auto json = bsoncxx::to_json(token);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.resumeToken = std::move(json);
+}
+
+void MaterializedProductRepository::setStreaming(bool streaming) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.streaming = streaming;
+}
+
+void MaterializedProductRepository::pause(std::chrono::milliseconds delay) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait_for(lock, delay, [this] { return stopping_.load(); });
+}
+
+} // namespace domain
@@ -1,15 +1,54 @@
 #include "domain/Product.h"
+#include <functional>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
 #include <stdexcept>
 
 namespace domain {
 
-Product::Product(const std::string& id, const std::string& name,
-                 const std::string& description, double price, int stock,
-                 const std::string& category)
-    : id_(id), name_(name), description_(description),
-      price_(price), stock_(stock), category_(category) {}
+const std::string* internCategory(std::string_view category) {
+    static std::shared_mutex mutex;
+    // Node-based, so pointers stay valid as names are added. The empty
+    // name is seeded so default-constructed products never miss.
+    static std::set<std::string, std::less<>> names{std::string()};
 
-std::string Product::getStatus() const {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = names.find(category);
+        if (it != names.end()) {
+            return &*it;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = names.find(category);
+    if (it != names.end()) {
+        return &*it;
+    }
+    if (names.size() >= kMaxInternedCategories) {
+        return nullptr;
+    }
+    return &*names.emplace(category).first;
+}
+
+Product::Product(std::string id, std::string name, std::string description,
+                 double price, int stock, std::string_view category)
+    : id_(std::move(id)), name_(std::move(name)), description_(std::move(description)),
+      price_(price), stock_(stock) {
+    setCategory(category);
+}
+
+void Product::setCategory(std::string_view category) {
+    if (auto interned = internCategory(category)) {
+        category_ = interned;
+        ownedCategory_.reset();
+    } else {
+        ownedCategory_ = std::make_shared<const std::string>(category);
+        category_ = ownedCategory_.get();
+    }
+}
+
+std::string_view Product::getStatus() const {
     if (stock_ > 10) {
         return "in-stock";
     } else if (stock_ > 0) {
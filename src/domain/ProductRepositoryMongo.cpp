@@ -1,9 +1,22 @@
 #include "domain/ProductRepositoryMongo.h"
 #include "utils/Logger.h"
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <mongocxx/bulk_write.hpp>
+#include <mongocxx/exception/bulk_write_exception.hpp>
 #include <mongocxx/exception/exception.hpp>
+#include <mongocxx/model/write.hpp>
+#include <mongocxx/options/bulk_write.hpp>
+#include <mongocxx/options/find.hpp>
+#include <mongocxx/options/find_one_and_update.hpp>
+#include <unordered_map>
+#include <unordered_set>
 #include <bsoncxx/oid.hpp>
+#include <bsoncxx/types.hpp>
+#include <chrono>
 
 using bsoncxx::builder::stream::document;
 using bsoncxx::builder::stream::finalize;
@@ -12,17 +25,85 @@ using bsoncxx::builder::stream::close_document;
 
 namespace domain {
 
+namespace {
+
+// Pool sizing is configured through the standard URI options
+std::string withPoolOptions(const std::string& connectionString,
+                            std::size_t minPoolSize, std::size_t maxPoolSize) {
+    std::string uri = connectionString;
+    std::string options;
+    if (uri.find("minPoolSize=") == std::string::npos) {
+        options += "minPoolSize=" + std::to_string(minPoolSize);
+    }
+    if (uri.find("maxPoolSize=") == std::string::npos) {
+        options += (options.empty() ? "" : "&") + std::string("maxPoolSize=") + std::to_string(maxPoolSize);
+    }
+    if (options.empty()) {
+        return uri;
+    }
+
+    if (uri.find('?') != std::string::npos) {
+        return uri + "&" + options;
+    }
+    auto hostStart = uri.find("://");
+    bool hasPath = hostStart != std::string::npos &&
+                   uri.find('/', hostStart + 3) != std::string::npos;
+    return uri + (hasPath ? "?" : "/?") + options;
+}
+
+} // namespace
+
 ProductRepositoryMongo::ProductRepositoryMongo(const std::string& connectionString,
-                                               const std::string& databaseName)
-    : client_(mongocxx::uri{connectionString}), db_(client_[databaseName]) {
-    utils::Logger::info("Connected to MongoDB database: " + databaseName);
+                                               const std::string& databaseName,
+                                               std::size_t minPoolSize,
+                                               std::size_t maxPoolSize)
+    : databaseName_(databaseName),
+      minPoolSize_(minPoolSize),
+      maxPoolSize_(maxPoolSize),
+      pool_(mongocxx::uri{withPoolOptions(connectionString, minPoolSize, maxPoolSize)}) {
+    utils::Logger::info("Connected to MongoDB database: {} (pool {}-{})",
+                        databaseName, minPoolSize, maxPoolSize);
+}
+
+ProductRepositoryMongo::ClientLease ProductRepositoryMongo::acquire() {
+    auto start = std::chrono::steady_clock::now();
+    auto entry = pool_.acquire();
+    auto waited = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+
+    checkouts_.fetch_add(1, std::memory_order_relaxed);
+    totalWaitNanos_.fetch_add(waited, std::memory_order_relaxed);
+    auto previousMax = maxWaitNanos_.load(std::memory_order_relaxed);
+    while (waited > previousMax &&
+           !maxWaitNanos_.compare_exchange_weak(previousMax, waited, std::memory_order_relaxed)) {
+    }
+    inUse_.fetch_add(1, std::memory_order_relaxed);
+
+    return ClientLease(std::move(entry), inUse_);
+}
+
+mongocxx::collection ProductRepositoryMongo::products(ClientLease& lease) {
+    return lease.client()[databaseName_]["products"];
 }
 
-std::pair<std::vector<Product>, std::optional<utils::AppError>> 
+MongoPoolStats ProductRepositoryMongo::getPoolStats() const {
+    MongoPoolStats stats;
+    stats.minSize = minPoolSize_;
+    stats.maxSize = maxPoolSize_;
+    stats.inUse = inUse_.load(std::memory_order_relaxed);
+    stats.checkouts = checkouts_.load(std::memory_order_relaxed);
+    stats.totalWaitSeconds = static_cast<double>(totalWaitNanos_.load(std::memory_order_relaxed)) / 1e9;
+    stats.maxWaitSeconds = static_cast<double>(maxWaitNanos_.load(std::memory_order_relaxed)) / 1e9;
+    return stats;
+}
+
+std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>> 
 ProductRepositoryMongo::findAll(const std::string& category) {
     try {
-        auto collection = db_["products"];
-        std::vector<Product> products;
+        auto lease = acquire();
+        auto collection = products(lease);
+        std::vector<ProductPtr> products;
 
         document filter_builder{};
         if (!category.empty()) {
@@ -35,18 +116,68 @@ ProductRepositoryMongo::findAll(const std::string& category) {
             products.push_back(documentToProduct(doc));
         }
 
-        utils::Logger::info("Found " + std::to_string(products.size()) + " products");
-        return {products, std::nullopt};
+        utils::Logger::debug("Found {} products", products.size());
+        return {std::move(products), std::nullopt};
     } catch (const mongocxx::exception& e) {
-        utils::Logger::error("MongoDB error in findAll: " + std::string(e.what()));
+        utils::Logger::error("MongoDB error in findAll: {}", e.what());
+        return {{}, utils::AppError::internalError("Database error occurred")};
+    }
+}
+
+std::pair<ProductPage, std::optional<utils::AppError>>
+ProductRepositoryMongo::findPage(const std::string& category, const std::string& afterId,
+                                 std::size_t limit) {
+    try {
+        auto lease = acquire();
+        auto collection = products(lease);
+        ProductPage page;
+
+        // Served by the _id index, or { category: 1, _id: 1 } when filtered
+        document filter_builder{};
+        if (!category.empty()) {
+            filter_builder << "category" << category;
+        }
+        if (!afterId.empty()) {
+            filter_builder << "_id" << open_document
+                           << "$gt" << bsoncxx::oid(afterId)
+                           << close_document;
+        }
+
+        document sort_builder{};
+        sort_builder << "_id" << 1;
+
+        // One extra document tells whether another page follows
+        mongocxx::options::find options;
+        options.sort(sort_builder.view());
+        options.limit(static_cast<std::int64_t>(limit) + 1);
+
+        auto cursor = collection.find(filter_builder.view(), options);
+
+        page.items.reserve(limit);
+        bool hasMore = false;
+        for (auto&& doc : cursor) {
+            if (page.items.size() == limit) {
+                hasMore = true;
+                break;
+            }
+            page.items.push_back(documentToProduct(doc));
+        }
+
+        if (hasMore && !page.items.empty()) {
+            page.nextCursor = page.items.back()->getId();
+        }
+        return {std::move(page), std::nullopt};
+    } catch (const std::exception& e) {
+        utils::Logger::error("Error in findPage: {}", e.what());
         return {{}, utils::AppError::internalError("Database error occurred")};
     }
 }
 
-std::pair<std::optional<Product>, std::optional<utils::AppError>> 
+std::pair<ProductPtr, std::optional<utils::AppError>> 
 ProductRepositoryMongo::findById(const std::string& id) {
     try {
-        auto collection = db_["products"];
+        auto lease = acquire();
+        auto collection = products(lease);
         
         document filter_builder{};
         filter_builder << "_id" << bsoncxx::oid(id);
@@ -54,73 +185,122 @@ ProductRepositoryMongo::findById(const std::string& id) {
         auto result = collection.find_one(filter_builder.view());
         
         if (result) {
-            Product product = documentToProduct(result->view());
-            return {product, std::nullopt};
+            return {documentToProduct(result->view()), std::nullopt};
         } else {
-            return {std::nullopt, utils::AppError::notFound("Product not found")};
+            return {nullptr, utils::AppError::notFound("Product not found")};
+        }
+    } catch (const std::exception& e) {
+        utils::Logger::error("Error in findById: {}", e.what());
+        return {nullptr, utils::AppError::internalError("Database error occurred")};
+    }
+}
+
+std::pair<std::vector<ProductPtr>, std::optional<utils::AppError>>
+ProductRepositoryMongo::findByIds(const std::vector<std::string>& ids) {
+    if (ids.empty()) {
+        return {{}, std::nullopt};
+    }
+
+    try {
+        auto lease = acquire();
+        auto collection = products(lease);
+
+        bsoncxx::builder::basic::array idArray;
+        for (const auto& id : ids) {
+            idArray.append(bsoncxx::oid(id));
+        }
+
+        document filter_builder{};
+        filter_builder << "_id" << open_document
+                       << "$in" << idArray.view()
+                       << close_document;
+
+        std::unordered_map<std::string_view, ProductPtr> found;
+        found.reserve(ids.size());
+        for (auto&& doc : collection.find(filter_builder.view())) {
+            auto product = documentToProduct(doc);
+            std::string_view id = product->getId();
+            found.emplace(id, std::move(product));
+        }
+
+        // $in returns documents in index order; restore the caller's order
+        std::vector<ProductPtr> products;
+        products.reserve(found.size());
+        for (const auto& id : ids) {
+            auto it = found.find(id);
+            if (it != found.end()) {
+                products.push_back(std::move(it->second));
+                found.erase(it);
+            }
         }
+        return {std::move(products), std::nullopt};
     } catch (const std::exception& e) {
-        utils::Logger::error("Error in findById: " + std::string(e.what()));
-        return {std::nullopt, utils::AppError::internalError("Database error occurred")};
+        utils::Logger::error("Error in findByIds: {}", e.what());
+        return {{}, utils::AppError::internalError("Database error occurred")};
     }
 }
 
 std::pair<std::string, std::optional<utils::AppError>> 
 ProductRepositoryMongo::create(const Product& product) {
     try {
-        auto collection = db_["products"];
+        auto lease = acquire();
+        auto collection = products(lease);
         
         auto doc = productToDocument(product);
         auto result = collection.insert_one(doc.view());
         
         if (result) {
             auto id = result->inserted_id().get_oid().value.to_string();
-            utils::Logger::info("Created product with ID: " + id);
+            utils::Logger::debug("Created product with ID: {}", id);
             return {id, std::nullopt};
         } else {
             return {"", utils::AppError::internalError("Failed to create product")};
         }
     } catch (const mongocxx::exception& e) {
-        utils::Logger::error("MongoDB error in create: " + std::string(e.what()));
+        utils::Logger::error("MongoDB error in create: {}", e.what());
         return {"", utils::AppError::internalError("Database error occurred")};
     }
 }
 
-std::optional<utils::AppError> 
+std::pair<ProductPtr, std::optional<utils::AppError>>
 ProductRepositoryMongo::update(const Product& product) {
-    try {
-        auto collection = db_["products"];
-        
-        document filter_builder{};
-        filter_builder << "_id" << bsoncxx::oid(product.getId());
-
-        document update_builder{};
-        update_builder << "$set" << open_document
-                      << "name" << product.getName()
-                      << "description" << product.getDescription()
-                      << "price" << product.getPrice()
-                      << "stock" << product.getStock()
-                      << "category" << product.getCategory()
-                      << close_document;
-
-        auto result = collection.update_one(filter_builder.view(), update_builder.view());
-        
-        if (result && result->matched_count() > 0) {
-            utils::Logger::info("Updated product: " + product.getId());
-            return std::nullopt;
-        } else {
-            return utils::AppError::notFound("Product not found");
-        }
-    } catch (const mongocxx::exception& e) {
-        utils::Logger::error("MongoDB error in update: " + std::string(e.what()));
-        return utils::AppError::internalError("Database error occurred");
+    return findAndUpdate(product.getId(), productToUpdate(product), "update");
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+ProductRepositoryMongo::patch(const std::string& id, const ProductPatch& patch) {
+    return findAndUpdate(id, patchToUpdate(patch), "patch");
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+ProductRepositoryMongo::reserveStock(const std::string& id, int quantity) {
+    // The stock condition and the decrement are one server-side step, so
+    // concurrent reservations can never take stock below zero
+    auto update = document{} << "$inc" << open_document << "stock" << -quantity
+                             << close_document << finalize;
+    auto result = findAndUpdate(id, update, "reserveStock", quantity);
+
+    // No match means a missing product or too little stock; only this
+    // refused path pays for a second query to tell them apart
+    if (!result.first && result.second &&
+        result.second->getCode() == utils::AppError::ErrorCode::NOT_FOUND && exists(id)) {
+        return {nullptr, utils::AppError::conflict("Insufficient stock")};
     }
+    return result;
+}
+
+std::pair<ProductPtr, std::optional<utils::AppError>>
+ProductRepositoryMongo::releaseStock(const std::string& id, int quantity) {
+    auto update = document{} << "$inc" << open_document << "stock" << quantity
+                             << close_document << finalize;
+    return findAndUpdate(id, update, "releaseStock");
 }
 
 std::optional<utils::AppError> 
 ProductRepositoryMongo::deleteById(const std::string& id) {
     try {
-        auto collection = db_["products"];
+        auto lease = acquire();
+        auto collection = products(lease);
         
         document filter_builder{};
         filter_builder << "_id" << bsoncxx::oid(id);
@@ -128,20 +308,171 @@ ProductRepositoryMongo::deleteById(const std::string& id) {
         auto result = collection.delete_one(filter_builder.view());
         
         if (result && result->deleted_count() > 0) {
-            utils::Logger::info("Deleted product: " + id);
+            utils::Logger::debug("Deleted product: {}", id);
             return std::nullopt;
         } else {
             return utils::AppError::notFound("Product not found");
         }
     } catch (const mongocxx::exception& e) {
-        utils::Logger::error("MongoDB error in deleteById: " + std::string(e.what()));
+        utils::Logger::error("MongoDB error in deleteById: {}", e.what());
         return utils::AppError::internalError("Database error occurred");
     }
 }
 
+std::pair<std::vector<BulkItemResult>, std::optional<utils::AppError>>
+ProductRepositoryMongo::bulkWrite(const std::vector<BulkOperation>& operations) {
+    std::vector<BulkItemResult> results(operations.size());
+    if (operations.empty()) {
+        return {results, std::nullopt};
+    }
+
+    try {
+        auto lease = acquire();
+        auto collection = products(lease);
+
+        // Ids among those given that are stored right now
+        auto findExisting = [&collection](const std::vector<std::string>& ids) {
+            std::unordered_set<std::string> found;
+            if (ids.empty()) {
+                return found;
+            }
+            bsoncxx::builder::basic::array idArray;
+            for (const auto& id : ids) {
+                idArray.append(bsoncxx::oid(id));
+            }
+
+            document filter_builder{};
+            filter_builder << "_id" << open_document
+                           << "$in" << idArray.view()
+                           << close_document;
+
+            document projection_builder{};
+            projection_builder << "_id" << 1;
+            mongocxx::options::find options;
+            options.projection(projection_builder.view());
+
+            for (auto&& doc : collection.find(filter_builder.view(), options)) {
+                found.insert(doc["_id"].get_oid().value.to_string());
+            }
+            return found;
+        };
+
+        // A bulk result only carries totals, so missing update/delete
+        // targets are found up front. This costs a second round trip and
+        // is racy: a target deleted between this find and the bulk is
+        // matched by nothing. The totals checked after the bulk catch that.
+        std::vector<std::string> targets;
+        for (const auto& op : operations) {
+            if (op.type != BulkOperation::Type::Create) {
+                targets.push_back(op.id);
+            }
+        }
+        auto existing = findExisting(targets);
+
+        mongocxx::options::bulk_write bulkOptions;
+        bulkOptions.ordered(false);
+        auto bulk = collection.create_bulk_write(bulkOptions);
+
+        // Position in the bulk request -> position in operations
+        std::vector<std::size_t> bulkIndex;
+        bulkIndex.reserve(operations.size());
+        std::vector<std::string> updated;
+        std::int32_t deletes = 0;
+
+        for (std::size_t i = 0; i < operations.size(); ++i) {
+            const auto& op = operations[i];
+
+            if (op.type == BulkOperation::Type::Create) {
+                // Ids are generated here so each item can report its own
+                bsoncxx::oid id;
+                Product product = op.product;
+                product.setId(id.to_string());
+                results[i].id = product.getId();
+                bulk.append(mongocxx::model::insert_one(productToDocument(product)));
+                bulkIndex.push_back(i);
+                continue;
+            }
+
+            results[i].id = op.id;
+            if (existing.find(op.id) == existing.end()) {
+                results[i].error = utils::AppError::notFound("Product not found");
+                continue;
+            }
+
+            document filter_builder{};
+            filter_builder << "_id" << bsoncxx::oid(op.id);
+
+            if (op.type == BulkOperation::Type::Update) {
+                bulk.append(mongocxx::model::update_one(filter_builder.view(),
+                                                        productToUpdate(op.product)));
+                updated.push_back(op.id);
+            } else {
+                bulk.append(mongocxx::model::delete_one(filter_builder.view()));
+                ++deletes;
+            }
+            bulkIndex.push_back(i);
+        }
+
+        if (!bulkIndex.empty()) {
+            try {
+                auto outcome = bulk.execute();
+                if (outcome && outcome->matched_count() < static_cast<std::int32_t>(updated.size())) {
+                    // Some update lost its target after the existence check;
+                    // whatever is still missing now is reported as such
+                    auto stillExisting = findExisting(updated);
+                    for (std::size_t index : bulkIndex) {
+                        const auto& op = operations[index];
+                        if (op.type == BulkOperation::Type::Update &&
+                            stillExisting.find(op.id) == stillExisting.end()) {
+                            results[index].error = utils::AppError::notFound("Product not found");
+                        }
+                    }
+                }
+                if (outcome && outcome->deleted_count() < deletes) {
+                    // Deleted concurrently: the product is gone either way,
+                    // but which item found nothing cannot be told from totals
+                    utils::Logger::warn("Bulk write: {} of {} deletes matched no product",
+                                        deletes - outcome->deleted_count(), deletes);
+                }
+            } catch (const mongocxx::bulk_write_exception& e) {
+                // Unordered: the other writes were applied; map each write error back
+                bool mapped = false;
+                if (e.raw_server_error()) {
+                    auto writeErrors = e.raw_server_error()->view()["writeErrors"];
+                    if (writeErrors && writeErrors.type() == bsoncxx::type::k_array) {
+                        for (auto&& element : writeErrors.get_array().value) {
+                            auto error = element.get_document().view();
+                            auto index = static_cast<std::size_t>(error["index"].get_int32().value);
+                            if (index >= bulkIndex.size()) {
+                                continue;
+                            }
+                            bool duplicate = error["code"] && error["code"].get_int32().value == 11000;
+                            results[bulkIndex[index]].error = duplicate
+                                ? utils::AppError::conflict("Product already exists")
+                                : utils::AppError::internalError("Database error occurred");
+                            mapped = true;
+                        }
+                    }
+                }
+                if (!mapped) {
+                    throw;
+                }
+                utils::Logger::warn("Bulk write completed with errors: {}", e.what());
+            }
+        }
+
+        utils::Logger::debug("Bulk write of {} operations", operations.size());
+        return {results, std::nullopt};
+    } catch (const std::exception& e) {
+        utils::Logger::error("Error in bulkWrite: {}", e.what());
+        return {{}, utils::AppError::internalError("Database error occurred")};
+    }
+}
+
 bool ProductRepositoryMongo::exists(const std::string& id) {
     try {
-        auto collection = db_["products"];
+        auto lease = acquire();
+        auto collection = products(lease);
         
         document filter_builder{};
         filter_builder << "_id" << bsoncxx::oid(id);
@@ -149,32 +480,99 @@ bool ProductRepositoryMongo::exists(const std::string& id) {
         auto count = collection.count_documents(filter_builder.view());
         return count > 0;
     } catch (const mongocxx::exception& e) {
-        utils::Logger::error("MongoDB error in exists: " + std::string(e.what()));
+        utils::Logger::error("MongoDB error in exists: {}", e.what());
         return false;
     }
 }
 
-Product ProductRepositoryMongo::documentToProduct(const bsoncxx::document::view& doc) {
-    Product product;
-    
-    product.setId(doc["_id"].get_oid().value.to_string());
-    product.setName(std::string(doc["name"].get_string().value));
-    product.setDescription(std::string(doc["description"].get_string().value));
-    
+std::pair<ProductPtr, std::optional<utils::AppError>>
+ProductRepositoryMongo::findAndUpdate(const std::string& id, const bsoncxx::document::value& update,
+                                      const char* operation, std::optional<int> minStock) {
+    try {
+        auto lease = acquire();
+        auto collection = products(lease);
+
+        document filter_builder{};
+        filter_builder << "_id" << bsoncxx::oid(id);
+        if (minStock) {
+            filter_builder << "stock" << open_document << "$gte" << *minStock << close_document;
+        }
+
+        // Match, write and read back the stored document in one round trip
+        mongocxx::options::find_one_and_update options;
+        options.return_document(mongocxx::options::return_document::k_after);
+
+        auto result = collection.find_one_and_update(filter_builder.view(), update.view(), options);
+
+        if (result) {
+            utils::Logger::debug("Updated product: {}", id);
+            return {documentToProduct(result->view()), std::nullopt};
+        } else {
+            return {nullptr, utils::AppError::notFound("Product not found")};
+        }
+    } catch (const std::exception& e) {
+        utils::Logger::error("MongoDB error in {}: {}", operation, e.what());
+        return {nullptr, utils::AppError::internalError("Database error occurred")};
+    }
+}
+
+ProductPtr ProductRepositoryMongo::documentToProduct(const bsoncxx::document::view& doc) {
     // Handle price as either double or int32
+    double price = 0.0;
     auto price_element = doc["price"];
     if (price_element.type() == bsoncxx::type::k_double) {
-        product.setPrice(price_element.get_double().value);
+        price = price_element.get_double().value;
     } else if (price_element.type() == bsoncxx::type::k_int32) {
-        product.setPrice(static_cast<double>(price_element.get_int32().value));
+        price = static_cast<double>(price_element.get_int32().value);
     } else if (price_element.type() == bsoncxx::type::k_int64) {
-        product.setPrice(static_cast<double>(price_element.get_int64().value));
+        price = static_cast<double>(price_element.get_int64().value);
     }
-    
-    product.setStock(doc["stock"].get_int32().value);
-    product.setCategory(std::string(doc["category"].get_string().value));
-    
-    return product;
+
+    // Strings are copied once, from the BSON buffer into the snapshot;
+    // the category only to be interned the first time it is seen
+    auto category = doc["category"].get_string().value;
+    return std::make_shared<const Product>(
+        doc["_id"].get_oid().value.to_string(),
+        std::string(doc["name"].get_string().value),
+        std::string(doc["description"].get_string().value),
+        price,
+        doc["stock"].get_int32().value,
+        std::string_view(category.data(), category.size()));
+}
+
+bsoncxx::document::value ProductRepositoryMongo::productToUpdate(const Product& product) {
+    document update_builder{};
+    update_builder << "$set" << open_document
+                  << "name" << product.getName()
+                  << "description" << product.getDescription()
+                  << "price" << product.getPrice()
+                  << "stock" << product.getStock()
+                  << "category" << product.getCategory()
+                  << close_document;
+    return update_builder << finalize;
+}
+
+bsoncxx::document::value ProductRepositoryMongo::patchToUpdate(const ProductPatch& patch) {
+    using bsoncxx::builder::basic::kvp;
+
+    bsoncxx::builder::basic::document fields{};
+    if (patch.name) {
+        fields.append(kvp("name", *patch.name));
+    }
+    if (patch.description) {
+        fields.append(kvp("description", *patch.description));
+    }
+    if (patch.price) {
+        fields.append(kvp("price", *patch.price));
+    }
+    if (patch.stock) {
+        fields.append(kvp("stock", *patch.stock));
+    }
+    if (patch.category) {
+        fields.append(kvp("category", *patch.category));
+    }
+    return bsoncxx::builder::basic::make_document(
+        kvp("$set", bsoncxx::types::b_document{fields.view()}));
 }
 
 bsoncxx::document::value ProductRepositoryMongo::productToDocument(const Product& product) {
@@ -1,6 +1,10 @@
 #include "config/Config.h"
 #include "utils/Logger.h"
 #include "domain/ProductRepositoryMongo.h"
+#include "domain/CachingProductRepository.h"
+#include "domain/InstrumentedProductRepository.h"
+#include "domain/InMemoryProductRepository.h"
+#include "domain/MaterializedProductRepository.h"
 #include "service/ProductService.h"
 #include "adapters/ProductHandler.h"
 #include "adapters/HttpServer.h"
@@ -13,17 +17,24 @@
 std::shared_ptr<adapters::HttpServer> g_server;
 
 void signalHandler(int signum) {
-    utils::Logger::info("Interrupt signal (" + std::to_string(signum) + ") received. Shutting down...");
+    utils::Logger::info("Interrupt signal ({}) received. Shutting down...", signum);
     if (g_server) {
         g_server->stop();
     }
+    utils::Logger::shutdown();
     exit(signum);
 }
 
 int main() {
     try {
         // Initialize logger
-        utils::Logger::init();
+        utils::LoggerOptions loggerOptions;
+        loggerOptions.level = config::Config::getLogLevel();
+        loggerOptions.async = config::Config::getLogAsync();
+        loggerOptions.queueSize = config::Config::getLogAsyncQueueSize();
+        loggerOptions.overflowPolicy = config::Config::getLogAsyncOverflow();
+        loggerOptions.accessLogSampleRate = config::Config::getAccessLogSampleRate();
+        utils::Logger::init(loggerOptions);
         utils::Logger::info("=== Product Catalog Microservice ===");
         utils::Logger::info("Starting application...");
 
@@ -35,29 +46,220 @@ int main() {
         utils::Logger::info("MongoDB C++ driver initialized");
 
         // Get configuration
+        auto backend = config::Config::getRepositoryBackend();
+        bool useMongo = backend != "memory";
+        bool materialized = backend == "materialized";
         auto mongoUri = config::Config::getMongoUri();
         auto dbName = config::Config::getDatabaseName();
         auto serverAddress = config::Config::getServerAddress();
         auto serverPort = config::Config::getServerPort();
 
+        adapters::ServerOptions serverOptions;
+        serverOptions.threads = config::Config::getServerThreads();
+        serverOptions.pinThreads = config::Config::getServerCpuPinning();
+        serverOptions.model = config::Config::getServerExecutionModel() == "per-core"
+            ? adapters::ExecutionModel::ThreadPerCore
+            : adapters::ExecutionModel::SharedIoContext;
+        serverOptions.maxRequestsPerConnection = config::Config::getKeepAliveMaxRequests();
+        serverOptions.keepAliveTimeout = std::chrono::seconds(config::Config::getKeepAliveTimeoutSeconds());
+        serverOptions.headerTimeout = std::chrono::seconds(config::Config::getHeaderTimeoutSeconds());
+        serverOptions.bodyTimeout = std::chrono::seconds(config::Config::getBodyTimeoutSeconds());
+        serverOptions.writeTimeout = std::chrono::seconds(config::Config::getWriteTimeoutSeconds());
+        serverOptions.maxConnections = config::Config::getMaxConnections();
+        serverOptions.maxBodySize = config::Config::getMaxBodyBytes();
+        serverOptions.compression.enabled = config::Config::getCompressionEnabled();
+        serverOptions.compression.level = config::Config::getCompressionLevel();
+        serverOptions.compression.minSize = config::Config::getCompressionMinBytes();
+
+        adapters::RequestHandlerOptions requestOptions;
+        auto blockingThreads = config::Config::getBlockingThreads();
+        if (blockingThreads < 0) {
+            blockingThreads = useMongo && !materialized
+                ? static_cast<int>(config::Config::getMongoPoolMaxSize()) : 0;
+        }
+        requestOptions.blockingThreads = static_cast<std::size_t>(blockingThreads);
+        requestOptions.maxQueued = config::Config::getBlockingQueueMax();
+
         utils::Logger::info("Configuration:");
-        utils::Logger::info("  MongoDB URI: " + mongoUri);
-        utils::Logger::info("  Database: " + dbName);
-        utils::Logger::info("  Server: " + serverAddress + ":" + std::to_string(serverPort));
+        utils::Logger::info("  Repository: {}", materialized ? "materialized" : useMongo ? "mongo" : "memory");
+        if (useMongo) {
+            utils::Logger::info("  MongoDB URI: {}", mongoUri);
+            utils::Logger::info("  Database: {}", dbName);
+        }
+        utils::Logger::info("  Server: {}:{}", serverAddress, serverPort);
+        utils::Logger::info("  Server threads: {} ({})", serverOptions.threads,
+                            config::Config::getServerExecutionModel());
+        utils::Logger::info("  Max connections: {}", serverOptions.maxConnections > 0
+                            ? std::to_string(serverOptions.maxConnections) : "unlimited");
+        if (requestOptions.blockingThreads > 0) {
+            utils::Logger::info("  Blocking threads: {}", requestOptions.blockingThreads);
+        }
+        if (serverOptions.compression.enabled) {
+            utils::Logger::info("  Compression: level {}, bodies from {} bytes",
+                                serverOptions.compression.level, serverOptions.compression.minSize);
+        }
+        utils::Logger::info("  Logging: {}{}, access log sample rate {}",
+                            loggerOptions.level, loggerOptions.async ? " (async)" : "",
+                            loggerOptions.accessLogSampleRate);
 
         // Wire up dependencies (Dependency Injection)
         // 1. Create repository (Secondary Adapter - outbound)
-        auto repository = std::make_shared<domain::ProductRepositoryMongo>(mongoUri, dbName);
+        auto& metrics = utils::MetricsRegistry::global();
+        // Bumped by the layer that sees writes (in-process store, change
+        // stream or product cache); the response cache checks it on every hit
+        auto generations = std::make_shared<domain::CatalogGenerations>();
+        bool writesTracked = !useMongo || materialized;
+        std::shared_ptr<domain::ProductRepository> store;
+        if (useMongo) {
+            auto mongoRepository = std::make_shared<domain::ProductRepositoryMongo>(
+                mongoUri, dbName,
+                config::Config::getMongoPoolMinSize(),
+                config::Config::getMongoPoolMaxSize());
+            metrics.addCollector([mongoRepository](utils::MetricsWriter& writer) {
+                auto stats = mongoRepository->getPoolStats();
+                writer.gauge("mongo_pool_max_size", "Maximum pooled MongoDB clients",
+                             static_cast<double>(stats.maxSize));
+                writer.gauge("mongo_pool_in_use", "MongoDB clients currently checked out",
+                             static_cast<double>(stats.inUse));
+                writer.counter("mongo_pool_checkouts_total", "MongoDB client checkouts",
+                               static_cast<double>(stats.checkouts));
+                writer.counter("mongo_pool_wait_seconds_total", "Time spent waiting for a MongoDB client",
+                               stats.totalWaitSeconds);
+            });
+            store = mongoRepository;
+
+            if (materialized) {
+                auto catalog = std::make_shared<domain::MaterializedProductRepository>(
+                    mongoUri, dbName, mongoRepository,
+                    config::Config::getMemoryRepositoryShards(), generations);
+                metrics.addCollector([catalog](utils::MetricsWriter& writer) {
+                    auto stats = catalog->getStats();
+                    writer.gauge("materialized_catalog_products", "Products held in the in-process catalog",
+                                 static_cast<double>(stats.products));
+                    writer.gauge("materialized_catalog_streaming", "1 while the change stream is open",
+                                 stats.streaming ? 1.0 : 0.0);
+                    writer.gauge("materialized_catalog_lag_seconds",
+                                 "Commit-to-apply delay of the latest change event", stats.lagSeconds);
+                    writer.gauge("materialized_catalog_resume_cluster_time_seconds",
+                                 "Cluster time of the latest change event applied",
+                                 static_cast<double>(stats.resumeClusterTime));
+                    writer.counter("materialized_catalog_events_total", "Change events applied",
+                                   static_cast<double>(stats.eventsApplied));
+                    writer.counter("materialized_catalog_resyncs_total", "Full reloads of the catalog",
+                                   static_cast<double>(stats.resyncs));
+                    writer.counter("materialized_catalog_reconnects_total", "Change stream reopenings",
+                                   static_cast<double>(stats.reconnects));
+                });
+                utils::Logger::info("Loading materialized catalog...");
+                catalog->start();
+                store = catalog;
+            }
+        } else {
+            store = std::make_shared<domain::InMemoryProductRepository>(
+                config::Config::getMemoryRepositoryShards(), generations);
+        }
+
+        // Latency is measured below the cache, so it reflects store calls
+        auto instrumented = std::make_shared<domain::InstrumentedProductRepository>(store);
+        std::shared_ptr<domain::ProductRepository> repository = instrumented;
+
+        // In-memory reads are already as fast as the cache would be
+        if (useMongo && !materialized && config::Config::getProductCacheEnabled()) {
+            domain::ProductCacheOptions cacheOptions;
+            cacheOptions.productCapacity = config::Config::getProductCacheCapacity();
+            cacheOptions.listCapacity = config::Config::getProductCacheListCapacity();
+            cacheOptions.shards = config::Config::getProductCacheShards();
+            cacheOptions.ttl = std::chrono::milliseconds(config::Config::getProductCacheTtlMs());
+            cacheOptions.negativeTtl = std::chrono::milliseconds(config::Config::getProductCacheNegativeTtlMs());
+            auto cache = std::make_shared<domain::CachingProductRepository>(
+                repository, cacheOptions, generations);
+            repository = cache;
+            writesTracked = true;
+
+            metrics.addCollector([cache](utils::MetricsWriter& writer) {
+                auto products = cache->getProductCacheStats();
+                auto lists = cache->getListCacheStats();
+                writer.counter("product_cache_hits_total", "Cache lookups served from memory",
+                               static_cast<double>(products.hits), "cache=\"product\"");
+                writer.counter("product_cache_hits_total", "Cache lookups served from memory",
+                               static_cast<double>(lists.hits), "cache=\"list\"");
+                writer.counter("product_cache_misses_total", "Cache lookups that went to the repository",
+                               static_cast<double>(products.misses), "cache=\"product\"");
+                writer.counter("product_cache_misses_total", "Cache lookups that went to the repository",
+                               static_cast<double>(lists.misses), "cache=\"list\"");
+                writer.counter("product_cache_evictions_total", "Entries evicted to stay within capacity",
+                               static_cast<double>(products.evictions), "cache=\"product\"");
+                writer.counter("product_cache_evictions_total", "Entries evicted to stay within capacity",
+                               static_cast<double>(lists.evictions), "cache=\"list\"");
+                writer.gauge("product_cache_entries", "Entries currently cached",
+                             static_cast<double>(products.size), "cache=\"product\"");
+                writer.gauge("product_cache_entries", "Entries currently cached",
+                             static_cast<double>(lists.size), "cache=\"list\"");
+            });
+            utils::Logger::info("Product cache enabled ({} products, {} ms TTL)",
+                                cacheOptions.productCapacity, cacheOptions.ttl.count());
+        }
         
         // 2. Create service (Business Logic)
         auto service = std::make_shared<service::ProductService>(repository);
         
         // 3. Create handler (Primary Adapter - inbound)
-        auto productHandler = std::make_shared<adapters::ProductHandler>(service);
-        auto requestHandler = std::make_shared<adapters::RequestHandler>(productHandler);
+        adapters::ProductHandlerOptions handlerOptions;
+        handlerOptions.defaultPageSize = config::Config::getDefaultPageSize();
+        handlerOptions.maxPageSize = config::Config::getMaxPageSize();
+        handlerOptions.maxBulkOperations = config::Config::getMaxBulkOperations();
+        auto& admission = handlerOptions.admission;
+        admission.maxInFlight = config::Config::getAdmissionMaxInFlight();
+        admission.maxInFlightPerRoute = config::Config::getAdmissionMaxInFlightPerRoute();
+        admission.routeLimits = adapters::AdmissionController::parseRouteLimits(
+            config::Config::getAdmissionRouteLimits());
+        admission.retryAfter = std::chrono::seconds(config::Config::getAdmissionRetryAfterSeconds());
+        admission.adaptive = config::Config::getAdmissionAdaptive();
+        admission.latencyTarget = std::chrono::milliseconds(config::Config::getAdmissionLatencyTargetMs());
+        admission.minLimit = config::Config::getAdmissionMinLimit();
+        std::shared_ptr<adapters::ResponseCache> responseCache;
+        if (config::Config::getResponseCacheEnabled() && writesTracked) {
+            adapters::ResponseCacheOptions responseCacheOptions;
+            responseCacheOptions.maxBytes = config::Config::getResponseCacheMaxBytes();
+            responseCacheOptions.ttl = std::chrono::milliseconds(config::Config::getResponseCacheTtlMs());
+            responseCacheOptions.compression = serverOptions.compression;
+            responseCache = std::make_shared<adapters::ResponseCache>(responseCacheOptions, generations);
+
+            metrics.addCollector([responseCache](utils::MetricsWriter& writer) {
+                auto stats = responseCache->stats();
+                writer.counter("response_cache_hits_total", "List responses served already serialized",
+                               static_cast<double>(stats.hits));
+                writer.counter("response_cache_misses_total", "List responses built from the repository",
+                               static_cast<double>(stats.misses));
+                writer.counter("response_cache_stale_total", "Cached responses dropped after a write to their category",
+                               static_cast<double>(stats.stale));
+                writer.counter("response_cache_evictions_total", "Responses evicted to stay within the byte budget",
+                               static_cast<double>(stats.evictions));
+                writer.gauge("response_cache_entries", "Responses currently cached",
+                             static_cast<double>(stats.entries));
+                writer.gauge("response_cache_bytes", "Bytes held by cached responses",
+                             static_cast<double>(stats.bytes));
+            });
+            utils::Logger::info("Response cache enabled ({} bytes)", responseCacheOptions.maxBytes);
+        } else if (config::Config::getResponseCacheEnabled()) {
+            utils::Logger::warn("Response cache needs the product cache with the mongo backend; disabled");
+        }
+        auto productHandler = std::make_shared<adapters::ProductHandler>(service, handlerOptions,
+                                                                         responseCache);
+        if (admission.adaptive) {
+            // The handler outlives the server, and with it every repository call
+            instrumented->setLatencyObserver([handler = productHandler.get()](auto latency) {
+                handler->admission().observeLatency(latency);
+            });
+            utils::Logger::info("Adaptive admission limit enabled (latency target {} ms)",
+                                admission.latencyTarget.count());
+        }
+        auto requestHandler = std::make_shared<adapters::RequestHandler>(productHandler,
+                                                                         requestOptions);
         
         // 4. Create HTTP server
-        g_server = std::make_shared<adapters::HttpServer>(serverAddress, serverPort, requestHandler);
+        g_server = std::make_shared<adapters::HttpServer>(serverAddress, serverPort,
+                                                          requestHandler, serverOptions);
 
         // Register signal handlers
         std::signal(SIGINT, signalHandler);
@@ -65,20 +267,30 @@ int main() {
 
         utils::Logger::info("Application started successfully!");
         utils::Logger::info("API Endpoints:");
+        // Braces are doubled: these are fmt format strings
         utils::Logger::info("  GET    /health");
+        utils::Logger::info("  GET    /metrics");
         utils::Logger::info("  GET    /products");
-        utils::Logger::info("  GET    /products/{id}");
+        utils::Logger::info("  GET    /products/{{id}}");
         utils::Logger::info("  POST   /products");
-        utils::Logger::info("  PUT    /products/{id}");
-        utils::Logger::info("  DELETE /products/{id}");
+        utils::Logger::info("  POST   /products/_bulk");
+        utils::Logger::info("  PUT    /products/{{id}}");
+        utils::Logger::info("  PATCH  /products/{{id}}");
+        utils::Logger::info("  DELETE /products/{{id}}");
+        utils::Logger::info("  POST   /products/{{id}}/reserve");
+        utils::Logger::info("  POST   /products/{{id}}/release");
+        utils::Logger::info("  POST   /products/_reserve");
+        utils::Logger::info("  POST   /products/_release");
 
         // Run the server
         g_server->run();
 
     } catch (const std::exception& e) {
-        utils::Logger::error("Fatal error: " + std::string(e.what()));
+        utils::Logger::error("Fatal error: {}", e.what());
+        utils::Logger::shutdown();
         return 1;
     }
 
+    utils::Logger::shutdown();
     return 0;
 }
@@ -1,33 +1,38 @@
 #include "service/ProductService.h"
 #include "utils/Logger.h"
+#include "utils/ObjectId.h"
+#include <unordered_set>
 
 namespace service {
 
 ProductService::ProductService(std::shared_ptr<domain::ProductRepository> repository)
     : repository_(std::move(repository)) {}
 
-std::pair<std::vector<dto::ProductResponse>, std::optional<utils::AppError>>
-ProductService::getAllProducts(const std::string& category) {
-    utils::Logger::info("Getting all products" + 
-                       (category.empty() ? "" : " for category: " + category));
+std::pair<dto::ProductPageResponse, std::optional<utils::AppError>>
+ProductService::getProductPage(const std::string& category, const std::string& afterId,
+                               std::size_t limit) {
+    utils::Logger::debug("Getting products (category: '{}', after: '{}', limit: {})",
+                         category, afterId, limit);
     
-    auto [products, error] = repository_->findAll(category);
+    auto [page, error] = repository_->findPage(category, afterId, limit);
     
     if (error) {
         return {{}, error};
     }
     
-    std::vector<dto::ProductResponse> response;
-    for (const auto& product : products) {
-        response.push_back(productToDto(product));
+    dto::ProductPageResponse response;
+    response.items.reserve(page.items.size());
+    for (auto& product : page.items) {
+        response.items.push_back(productToDto(std::move(product)));
     }
+    response.nextCursor = std::move(page.nextCursor);
     
-    return {response, std::nullopt};
+    return {std::move(response), std::nullopt};
 }
 
 std::pair<std::optional<dto::ProductResponse>, std::optional<utils::AppError>>
 ProductService::getProduct(const std::string& id) {
-    utils::Logger::info("Getting product: " + id);
+    utils::Logger::debug("Getting product: {}", id);
     
     auto [product, error] = repository_->findById(id);
     
@@ -39,12 +44,41 @@ ProductService::getProduct(const std::string& id) {
         return {std::nullopt, utils::AppError::notFound("Product not found")};
     }
     
-    return {productToDto(*product), std::nullopt};
+    return {productToDto(std::move(product)), std::nullopt};
+}
+
+std::pair<dto::ProductBatchResponse, std::optional<utils::AppError>>
+ProductService::getProductsByIds(const std::vector<std::string>& ids) {
+    utils::Logger::debug("Getting {} products by id", ids.size());
+
+    auto [products, error] = repository_->findByIds(ids);
+
+    if (error) {
+        return {{}, error};
+    }
+
+    // Products come back in request order, so missing ids are the gaps
+    dto::ProductBatchResponse response;
+    std::size_t next = 0;
+    for (const auto& id : ids) {
+        if (next < products.size() && products[next]->getId() == id) {
+            ++next;
+        } else {
+            response.missing.push_back(id);
+        }
+    }
+
+    response.items.reserve(products.size());
+    for (auto& product : products) {
+        response.items.push_back(productToDto(std::move(product)));
+    }
+
+    return {std::move(response), std::nullopt};
 }
 
 std::pair<dto::ProductResponse, std::optional<utils::AppError>>
 ProductService::createProduct(const dto::CreateProductRequest& request) {
-    utils::Logger::info("Creating product: " + request.name);
+    utils::Logger::debug("Creating product: {}", request.name);
     
     // Validate request
     if (!request.isValid()) {
@@ -52,67 +86,259 @@ ProductService::createProduct(const dto::CreateProductRequest& request) {
     }
     
     // Create domain entity
-    domain::Product product("", request.name, request.description,
-                           request.price, request.stock, request.category);
+    auto product = std::make_shared<domain::Product>("", request.name, request.description,
+                                                     request.price, request.stock, request.category);
     
     // Save to repository
-    auto [id, error] = repository_->create(product);
+    auto [id, error] = repository_->create(*product);
     
     if (error) {
         return {{}, error};
     }
     
-    // Fetch the created product
-    product.setId(id);
+    product->setId(std::move(id));
     
-    return {productToDto(product), std::nullopt};
+    return {productToDto(std::move(product)), std::nullopt};
 }
 
 std::pair<dto::ProductResponse, std::optional<utils::AppError>>
 ProductService::updateProduct(const dto::UpdateProductRequest& request) {
-    utils::Logger::info("Updating product: " + request.id);
+    utils::Logger::debug("Updating product: {}", request.id);
     
     // Validate request
     if (!request.isValid()) {
         return {{}, utils::AppError::badRequest("Invalid product data")};
     }
     
-    // Check if product exists
-    if (!repository_->exists(request.id)) {
-        return {{}, utils::AppError::notFound("Product not found")};
-    }
-    
     // Create updated domain entity
     domain::Product product(request.id, request.name, request.description,
                            request.price, request.stock, request.category);
     
-    // Update in repository
-    auto error = repository_->update(product);
+    // Update in repository; a missing product is reported by the update itself
+    auto [updated, error] = repository_->update(product);
     
     if (error) {
         return {{}, error};
     }
     
-    return {productToDto(product), std::nullopt};
+    return {productToDto(std::move(updated)), std::nullopt};
+}
+
+std::pair<dto::ProductResponse, std::optional<utils::AppError>>
+ProductService::patchProduct(const dto::PatchProductRequest& request) {
+    utils::Logger::debug("Patching product: {}", request.id);
+
+    if (!request.hasChanges()) {
+        return {{}, utils::AppError::badRequest("No fields to update")};
+    }
+    if (!request.isValid()) {
+        return {{}, utils::AppError::badRequest("Invalid product data")};
+    }
+
+    domain::ProductPatch patch;
+    patch.name = request.name;
+    patch.description = request.description;
+    patch.price = request.price;
+    patch.stock = request.stock;
+    patch.category = request.category;
+
+    auto [updated, error] = repository_->patch(request.id, patch);
+
+    if (error) {
+        return {{}, error};
+    }
+
+    return {productToDto(std::move(updated)), std::nullopt};
+}
+
+std::pair<dto::StockLevelResponse, std::optional<utils::AppError>>
+ProductService::reserveStock(const dto::StockChangeRequest& request) {
+    utils::Logger::debug("Reserving {} of product: {}", request.quantity, request.id);
+    return changeStock(request, &domain::ProductRepository::reserveStock);
+}
+
+std::pair<dto::StockLevelResponse, std::optional<utils::AppError>>
+ProductService::releaseStock(const dto::StockChangeRequest& request) {
+    utils::Logger::debug("Releasing {} of product: {}", request.quantity, request.id);
+    return changeStock(request, &domain::ProductRepository::releaseStock);
+}
+
+std::pair<dto::StockBatchResponse, std::optional<utils::AppError>>
+ProductService::reserveStockBatch(const dto::StockBatchRequest& request) {
+    utils::Logger::debug("Reserving stock for {} products", request.items.size());
+    return changeStockBatch(request, &domain::ProductRepository::reserveStock,
+                            &domain::ProductRepository::releaseStock);
+}
+
+std::pair<dto::StockBatchResponse, std::optional<utils::AppError>>
+ProductService::releaseStockBatch(const dto::StockBatchRequest& request) {
+    utils::Logger::debug("Releasing stock for {} products", request.items.size());
+    return changeStockBatch(request, &domain::ProductRepository::releaseStock,
+                            &domain::ProductRepository::reserveStock);
 }
 
 std::optional<utils::AppError>
 ProductService::deleteProduct(const std::string& id) {
-    utils::Logger::info("Deleting product: " + id);
+    utils::Logger::debug("Deleting product: {}", id);
     
     return repository_->deleteById(id);
 }
 
-dto::ProductResponse ProductService::productToDto(const domain::Product& product) {
-    dto::ProductResponse response;
-    response.id = product.getId();
-    response.name = product.getName();
-    response.description = product.getDescription();
-    response.price = product.getPrice();
-    response.stock = product.getStock();
-    response.category = product.getCategory();
-    response.status = product.getStatus();
-    return response;
+std::pair<dto::BulkWriteResponse, std::optional<utils::AppError>>
+ProductService::bulkWrite(const dto::BulkWriteRequest& request) {
+    utils::Logger::debug("Bulk write of {} operations", request.operations.size());
+
+    dto::BulkWriteResponse response;
+    response.results.resize(request.operations.size());
+
+    // Invalid items are answered here; only valid ones reach the repository
+    std::vector<domain::BulkOperation> operations;
+    std::vector<std::size_t> positions;
+    operations.reserve(request.operations.size());
+    positions.reserve(request.operations.size());
+
+    for (std::size_t i = 0; i < request.operations.size(); ++i) {
+        const auto& item = request.operations[i];
+        auto& result = response.results[i];
+        result.index = i;
+        result.id = item.id;
+
+        domain::BulkOperation operation;
+        operation.id = item.id;
+        std::string invalid;
+
+        if (item.op == "create") {
+            operation.type = domain::BulkOperation::Type::Create;
+            operation.id.clear();
+            result.id.clear();
+            if (!item.product.isValid()) {
+                invalid = "Invalid product data";
+            }
+        } else if (item.op == "update") {
+            operation.type = domain::BulkOperation::Type::Update;
+            if (!utils::ObjectId::isValid(item.id)) {
+                invalid = "Invalid product id";
+            } else if (!item.product.isValid()) {
+                invalid = "Invalid product data";
+            }
+        } else if (item.op == "delete") {
+            operation.type = domain::BulkOperation::Type::Delete;
+            if (!utils::ObjectId::isValid(item.id)) {
+                invalid = "Invalid product id";
+            }
+        } else {
+            invalid = "Invalid operation";
+        }
+
+        if (!invalid.empty()) {
+            result.status = static_cast<int>(utils::AppError::ErrorCode::BAD_REQUEST);
+            result.message = std::move(invalid);
+            continue;
+        }
+
+        // Stores and caches compare ids in canonical form
+        if (operation.type != domain::BulkOperation::Type::Create) {
+            operation.id = utils::ObjectId::normalize(operation.id);
+            result.id = operation.id;
+        }
+
+        if (operation.type != domain::BulkOperation::Type::Delete) {
+            operation.product = domain::Product(operation.id, item.product.name,
+                                                item.product.description, item.product.price,
+                                                item.product.stock, item.product.category);
+        }
+        operations.push_back(std::move(operation));
+        positions.push_back(i);
+    }
+
+    if (!operations.empty()) {
+        auto [items, error] = repository_->bulkWrite(operations);
+
+        if (error) {
+            return {{}, error};
+        }
+
+        for (std::size_t j = 0; j < positions.size() && j < items.size(); ++j) {
+            auto& result = response.results[positions[j]];
+            result.id = items[j].id;
+            if (items[j].error) {
+                result.status = items[j].error->getHttpCode();
+                result.message = items[j].error->getMessage();
+            } else {
+                result.status = operations[j].type == domain::BulkOperation::Type::Create ? 201 : 200;
+            }
+        }
+    }
+
+    for (const auto& result : response.results) {
+        if (result.status >= 200 && result.status < 300) {
+            ++response.succeeded;
+        } else {
+            ++response.failed;
+        }
+    }
+
+    return {std::move(response), std::nullopt};
+}
+
+std::pair<dto::StockLevelResponse, std::optional<utils::AppError>>
+ProductService::changeStock(const dto::StockChangeRequest& request, StockChange change) {
+    if (!request.isValid()) {
+        return {{}, utils::AppError::badRequest("Invalid quantity")};
+    }
+
+    auto [product, error] = (*repository_.*change)(request.id, request.quantity);
+
+    if (error) {
+        return {{}, error};
+    }
+
+    return {dto::StockLevelResponse{product->getId(), product->getStock()}, std::nullopt};
+}
+
+std::pair<dto::StockBatchResponse, std::optional<utils::AppError>>
+ProductService::changeStockBatch(const dto::StockBatchRequest& request, StockChange change,
+                                 StockChange undo) {
+    std::unordered_set<std::string> seen;
+    for (const auto& item : request.items) {
+        if (!utils::ObjectId::isValid(item.id)) {
+            return {{}, utils::AppError::badRequest("Invalid id: " + item.id)};
+        }
+        if (!item.isValid()) {
+            return {{}, utils::AppError::badRequest("Invalid quantity for " + item.id)};
+        }
+        if (!seen.insert(utils::ObjectId::normalize(item.id)).second) {
+            return {{}, utils::AppError::badRequest("Duplicate id: " + item.id)};
+        }
+    }
+
+    dto::StockBatchResponse response;
+    response.items.reserve(request.items.size());
+
+    for (const auto& item : request.items) {
+        auto [product, error] = (*repository_.*change)(item.id, item.quantity);
+        if (!error) {
+            response.items.push_back({product->getId(), product->getStock()});
+            continue;
+        }
+
+        // Compensate, newest first. Each step is atomic on its own, so a
+        // failure here leaves that item changed and is only logged.
+        for (std::size_t i = response.items.size(); i-- > 0;) {
+            const auto& applied = request.items[i];
+            if (auto undoError = (*repository_.*undo)(applied.id, applied.quantity).second) {
+                utils::Logger::error("Could not revert stock of {} by {}: {}", applied.id,
+                                     applied.quantity, undoError->getMessage());
+            }
+        }
+        return {{}, utils::AppError(error->getCode(), error->getMessage() + ": " + item.id)};
+    }
+
+    return {std::move(response), std::nullopt};
+}
+
+dto::ProductResponse ProductService::productToDto(domain::ProductPtr product) {
+    return dto::ProductResponse{std::move(product)};
 }
 
 } // namespace service
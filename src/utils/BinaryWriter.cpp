@@ -0,0 +1,191 @@
+#include "utils/BinaryWriter.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace utils {
+
+namespace {
+
+void appendBigEndian(std::string& out, std::uint64_t value, std::size_t bytes) {
+    char buffer[8];
+    for (std::size_t i = 0; i < bytes; ++i) {
+        buffer[i] = static_cast<char>(value >> ((bytes - 1 - i) * 8));
+    }
+    out.append(buffer, bytes);
+}
+
+void appendByte(std::string& out, std::uint8_t byte) {
+    out.push_back(static_cast<char>(byte));
+}
+
+// Marker, then the value in the width the marker announces
+void appendSized(std::string& out, std::uint8_t marker, std::uint64_t value, std::size_t bytes) {
+    appendByte(out, marker);
+    appendBigEndian(out, value, bytes);
+}
+
+bool fitsFloat(double number) {
+    return number >= static_cast<double>(std::numeric_limits<float>::lowest()) &&
+           number <= static_cast<double>(std::numeric_limits<float>::max()) &&
+           static_cast<double>(static_cast<float>(number)) == number;
+}
+
+// Single precision when it loses nothing, double otherwise
+void appendFloat(std::string& out, double number, std::uint8_t singleMarker,
+                 std::uint8_t doubleMarker) {
+    if (fitsFloat(number)) {
+        float narrow = static_cast<float>(number);
+        std::uint32_t bits;
+        std::memcpy(&bits, &narrow, sizeof(bits));
+        appendSized(out, singleMarker, bits, 4);
+    } else {
+        std::uint64_t bits;
+        std::memcpy(&bits, &number, sizeof(bits));
+        appendSized(out, doubleMarker, bits, 8);
+    }
+}
+
+} // namespace
+
+// MessagePack
+
+void MsgPackWriter::beginObject(std::size_t members) {
+    if (members <= 15) {
+        appendByte(out_, static_cast<std::uint8_t>(0x80 | members));
+    } else if (members <= 0xFFFF) {
+        appendSized(out_, 0xDE, members, 2);
+    } else {
+        appendSized(out_, 0xDF, members, 4);
+    }
+}
+
+void MsgPackWriter::beginArray(std::size_t elements) {
+    if (elements <= 15) {
+        appendByte(out_, static_cast<std::uint8_t>(0x90 | elements));
+    } else if (elements <= 0xFFFF) {
+        appendSized(out_, 0xDC, elements, 2);
+    } else {
+        appendSized(out_, 0xDD, elements, 4);
+    }
+}
+
+void MsgPackWriter::value(std::string_view text) {
+    auto length = text.size();
+    if (length <= 31) {
+        appendByte(out_, static_cast<std::uint8_t>(0xA0 | length));
+    } else if (length <= 0xFF) {
+        appendSized(out_, 0xD9, length, 1);
+    } else if (length <= 0xFFFF) {
+        appendSized(out_, 0xDA, length, 2);
+    } else {
+        appendSized(out_, 0xDB, length, 4);
+    }
+    out_.append(text);
+}
+
+void MsgPackWriter::value(double number) {
+    appendFloat(out_, number, 0xCA, 0xCB);
+}
+
+void MsgPackWriter::value(std::int64_t number) {
+    if (number >= 0) {
+        value(static_cast<std::uint64_t>(number));
+    } else if (number >= -32) {
+        appendByte(out_, static_cast<std::uint8_t>(number));
+    } else if (number >= std::numeric_limits<std::int8_t>::min()) {
+        appendSized(out_, 0xD0, static_cast<std::uint64_t>(number), 1);
+    } else if (number >= std::numeric_limits<std::int16_t>::min()) {
+        appendSized(out_, 0xD1, static_cast<std::uint64_t>(number), 2);
+    } else if (number >= std::numeric_limits<std::int32_t>::min()) {
+        appendSized(out_, 0xD2, static_cast<std::uint64_t>(number), 4);
+    } else {
+        appendSized(out_, 0xD3, static_cast<std::uint64_t>(number), 8);
+    }
+}
+
+void MsgPackWriter::value(std::uint64_t number) {
+    if (number <= 0x7F) {
+        appendByte(out_, static_cast<std::uint8_t>(number));
+    } else if (number <= 0xFF) {
+        appendSized(out_, 0xCC, number, 1);
+    } else if (number <= 0xFFFF) {
+        appendSized(out_, 0xCD, number, 2);
+    } else if (number <= 0xFFFFFFFF) {
+        appendSized(out_, 0xCE, number, 4);
+    } else {
+        appendSized(out_, 0xCF, number, 8);
+    }
+}
+
+void MsgPackWriter::value(bool flag) {
+    appendByte(out_, flag ? 0xC3 : 0xC2);
+}
+
+void MsgPackWriter::null() {
+    appendByte(out_, 0xC0);
+}
+
+// CBOR
+
+void CborWriter::head(std::uint8_t major, std::uint64_t argument) {
+    auto initial = static_cast<std::uint8_t>(major << 5);
+    if (argument <= 23) {
+        appendByte(out_, static_cast<std::uint8_t>(initial | argument));
+    } else if (argument <= 0xFF) {
+        appendSized(out_, initial | 24, argument, 1);
+    } else if (argument <= 0xFFFF) {
+        appendSized(out_, initial | 25, argument, 2);
+    } else if (argument <= 0xFFFFFFFF) {
+        appendSized(out_, initial | 26, argument, 4);
+    } else {
+        appendSized(out_, initial | 27, argument, 8);
+    }
+}
+
+void CborWriter::beginObject(std::size_t members) {
+    head(5, members);
+}
+
+void CborWriter::beginArray(std::size_t elements) {
+    head(4, elements);
+}
+
+void CborWriter::value(std::string_view text) {
+    head(3, text.size());
+    out_.append(text);
+}
+
+void CborWriter::value(double number) {
+    // Half precision encodings of NaN and the infinities
+    if (std::isnan(number)) {
+        appendSized(out_, 0xF9, 0x7E00, 2);
+    } else if (std::isinf(number)) {
+        appendSized(out_, 0xF9, number > 0 ? 0x7C00 : 0xFC00, 2);
+    } else {
+        appendFloat(out_, number, 0xFA, 0xFB);
+    }
+}
+
+void CborWriter::value(std::int64_t number) {
+    if (number >= 0) {
+        head(0, static_cast<std::uint64_t>(number));
+    } else {
+        // Major type 1 carries -1 - n
+        head(1, static_cast<std::uint64_t>(-(number + 1)));
+    }
+}
+
+void CborWriter::value(std::uint64_t number) {
+    head(0, number);
+}
+
+void CborWriter::value(bool flag) {
+    appendByte(out_, flag ? 0xF5 : 0xF4);
+}
+
+void CborWriter::null() {
+    appendByte(out_, 0xF6);
+}
+
+} // namespace utils
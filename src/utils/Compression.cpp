@@ -0,0 +1,137 @@
+#include "utils/Compression.h"
+#include "utils/AcceptList.h"
+#include <zlib.h>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace utils {
+
+namespace {
+
+// Smallest amount the output buffer grows by per deflate() call
+constexpr std::size_t kOutputStep = 16 * 1024;
+
+constexpr int kWindowBits = 15;
+// Added to the window bits, selects the gzip wrapper instead of zlib
+constexpr int kGzipWrapper = 16;
+constexpr int kMemLevel = 8;
+
+} // namespace
+
+std::string_view contentEncodingName(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Gzip:
+            return "gzip";
+        case ContentEncoding::Deflate:
+            return "deflate";
+        case ContentEncoding::Identity:
+            break;
+    }
+    return "identity";
+}
+
+ContentEncoding negotiateEncoding(std::string_view acceptEncoding) {
+    // -1 marks a coding the header does not mention
+    double gzip = -1.0;
+    double deflate = -1.0;
+    double wildcard = -1.0;
+
+    AcceptList items(acceptEncoding);
+    std::string_view coding;
+    double quality = 0.0;
+    while (items.next(coding, quality)) {
+        if (AcceptList::equalsIgnoreCase(coding, "gzip") ||
+            AcceptList::equalsIgnoreCase(coding, "x-gzip")) {
+            gzip = quality;
+        } else if (AcceptList::equalsIgnoreCase(coding, "deflate")) {
+            deflate = quality;
+        } else if (coding == "*") {
+            wildcard = quality;
+        }
+    }
+
+    if (gzip < 0) {
+        gzip = wildcard;
+    }
+    if (deflate < 0) {
+        deflate = wildcard;
+    }
+
+    if (gzip > 0 && gzip >= deflate) {
+        return ContentEncoding::Gzip;
+    }
+    if (deflate > 0) {
+        return ContentEncoding::Deflate;
+    }
+    return ContentEncoding::Identity;
+}
+
+Compressor::Compressor(ContentEncoding encoding, int level) : stream_(std::make_unique<z_stream>()) {
+    if (encoding == ContentEncoding::Identity) {
+        throw std::invalid_argument("Compressor needs gzip or deflate");
+    }
+    int windowBits = encoding == ContentEncoding::Gzip ? kWindowBits + kGzipWrapper : kWindowBits;
+    level = std::clamp(level, Z_BEST_SPEED, Z_BEST_COMPRESSION);
+    if (deflateInit2(stream_.get(), level, Z_DEFLATED, windowBits, kMemLevel,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("Failed to initialize zlib");
+    }
+}
+
+Compressor::~Compressor() {
+    deflateEnd(stream_.get());
+}
+
+void Compressor::write(std::string_view input, std::string& out) {
+    deflateInto(input, Z_NO_FLUSH, out);
+}
+
+void Compressor::flush(std::string& out) {
+    deflateInto({}, Z_SYNC_FLUSH, out);
+}
+
+void Compressor::finish(std::string& out) {
+    deflateInto({}, Z_FINISH, out);
+}
+
+std::string Compressor::compress(ContentEncoding encoding, int level, std::string_view input) {
+    Compressor compressor(encoding, level);
+    std::string out;
+    // JSON usually shrinks severalfold; the buffer grows if it does not
+    out.reserve(input.size() / 4 + 64);
+    compressor.write(input, out);
+    compressor.finish(out);
+    return out;
+}
+
+void Compressor::deflateInto(std::string_view input, int mode, std::string& out) {
+    constexpr std::size_t kMaxLength = std::numeric_limits<uInt>::max();
+
+    // zlib counts bytes in uInt, so very large bodies go in slices
+    do {
+        auto slice = input.substr(0, kMaxLength);
+        input.remove_prefix(slice.size());
+        int sliceMode = input.empty() ? mode : Z_NO_FLUSH;
+
+        stream_->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(slice.data()));
+        stream_->avail_in = static_cast<uInt>(slice.size());
+
+        int rc = Z_OK;
+        do {
+            auto used = out.size();
+            auto step = std::min(std::max(kOutputStep, out.capacity() - used), kMaxLength);
+            out.resize(used + step);
+            stream_->next_out = reinterpret_cast<Bytef*>(&out[used]);
+            stream_->avail_out = static_cast<uInt>(step);
+
+            rc = deflate(stream_.get(), sliceMode);
+            out.resize(used + step - stream_->avail_out);
+            if (rc == Z_STREAM_ERROR) {
+                throw std::runtime_error("zlib stream error");
+            }
+        } while (stream_->avail_out == 0 || (sliceMode == Z_FINISH && rc != Z_STREAM_END));
+    } while (!input.empty());
+}
+
+} // namespace utils
@@ -0,0 +1,159 @@
+#include "utils/JsonWriter.h"
+#include "utils/Utf8.h"
+#include <charconv>
+#include <cmath>
+
+namespace utils {
+
+namespace {
+
+constexpr char kHex[] = "0123456789abcdef";
+
+} // namespace
+
+void JsonWriter::prefix() {
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (needComma_) {
+        out_.push_back(',');
+    }
+}
+
+void JsonWriter::beginObject(std::size_t) {
+    prefix();
+    out_.push_back('{');
+    needComma_ = false;
+}
+
+void JsonWriter::endObject() {
+    out_.push_back('}');
+    needComma_ = true;
+}
+
+void JsonWriter::beginArray(std::size_t) {
+    prefix();
+    out_.push_back('[');
+    needComma_ = false;
+}
+
+void JsonWriter::endArray() {
+    out_.push_back(']');
+    needComma_ = true;
+}
+
+void JsonWriter::key(std::string_view name) {
+    prefix();
+    writeString(name);
+    out_.push_back(':');
+    afterKey_ = true;
+}
+
+void JsonWriter::value(std::string_view text) {
+    prefix();
+    writeString(text);
+    needComma_ = true;
+}
+
+void JsonWriter::value(double number) {
+    prefix();
+    needComma_ = true;
+
+    // JSON has no representation for NaN or infinity
+    if (!std::isfinite(number)) {
+        out_.append("null");
+        return;
+    }
+
+    char buffer[32];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    std::string_view digits(buffer, static_cast<std::size_t>(end - buffer));
+    out_.append(digits);
+
+    // Keep integral doubles recognizable as floating point ("10.0")
+    if (digits.find_first_of(".e") == std::string_view::npos) {
+        out_.append(".0");
+    }
+}
+
+void JsonWriter::value(std::int64_t number) {
+    prefix();
+    char buffer[24];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out_.append(buffer, static_cast<std::size_t>(end - buffer));
+    needComma_ = true;
+}
+
+void JsonWriter::value(std::uint64_t number) {
+    prefix();
+    char buffer[24];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out_.append(buffer, static_cast<std::size_t>(end - buffer));
+    needComma_ = true;
+}
+
+void JsonWriter::value(bool flag) {
+    prefix();
+    out_.append(flag ? "true" : "false");
+    needComma_ = true;
+}
+
+void JsonWriter::null() {
+    prefix();
+    out_.append("null");
+    needComma_ = true;
+}
+
+void JsonWriter::writeString(std::string_view text) {
+    out_.push_back('"');
+
+    std::size_t runStart = 0;
+    std::size_t i = 0;
+    while (i < text.size()) {
+        auto c = static_cast<unsigned char>(text[i]);
+
+        if (c >= 0x20 && c != '"' && c != '\\' && c < 0x80) {
+            ++i;
+            continue;
+        }
+
+        if (c >= 0x80) {
+            auto length = utf8SequenceLength(text, i);
+            if (length > 0) {
+                i += length;
+                continue;
+            }
+        }
+
+        // Flush the run of bytes that needed no escaping
+        out_.append(text.data() + runStart, i - runStart);
+
+        switch (c) {
+            case '"':  out_.append("\\\""); break;
+            case '\\': out_.append("\\\\"); break;
+            case '\b': out_.append("\\b"); break;
+            case '\f': out_.append("\\f"); break;
+            case '\n': out_.append("\\n"); break;
+            case '\r': out_.append("\\r"); break;
+            case '\t': out_.append("\\t"); break;
+            default:
+                if (c < 0x20) {
+                    char escaped[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0x0F]};
+                    out_.append(escaped, sizeof(escaped));
+                } else {
+                    // Invalid UTF-8 byte: emit the replacement character
+                    out_.append("\\ufffd");
+                }
+                break;
+        }
+
+        ++i;
+        runStart = i;
+    }
+
+    out_.append(text.data() + runStart, text.size() - runStart);
+    out_.push_back('"');
+}
+
+} // namespace utils
@@ -1,29 +1,74 @@
 #include "utils/Logger.h"
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <cmath>
 
 namespace utils {
 
-void Logger::init() {
-    auto console = spdlog::stdout_color_mt("console");
+std::shared_ptr<spdlog::logger> Logger::accessLogger_;
+std::uint32_t Logger::accessSamplePeriod_{1};
+
+void Logger::init(const LoggerOptions& options) {
+    // Access lines get their own sink so they can use their own pattern
+    auto consoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    auto accessSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+
+    std::shared_ptr<spdlog::logger> console;
+    if (options.async) {
+        auto policy = options.overflowPolicy == "drop"
+            ? spdlog::async_overflow_policy::overrun_oldest
+            : spdlog::async_overflow_policy::block;
+        spdlog::init_thread_pool(options.queueSize, 1);
+        console = std::make_shared<spdlog::async_logger>(
+            "console", consoleSink, spdlog::thread_pool(), policy);
+        accessLogger_ = std::make_shared<spdlog::async_logger>(
+            "access", accessSink, spdlog::thread_pool(), policy);
+    } else {
+        console = std::make_shared<spdlog::logger>("console", consoleSink);
+        accessLogger_ = std::make_shared<spdlog::logger>("access", accessSink);
+    }
+
     spdlog::set_default_logger(console);
-    spdlog::set_level(spdlog::level::info);
+    spdlog::set_level(spdlog::level::from_str(options.level));
     spdlog::set_pattern("[%Y-%m-%d %H:%M:%S] [%^%l%$] %v");
-}
 
-void Logger::info(const std::string& message) {
-    spdlog::info(message);
+    // The access log is governed by its sample rate, not the log level
+    accessLogger_->set_level(spdlog::level::info);
+    accessLogger_->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [access] %v");
+
+    // A rate of 1/N logs every Nth request on each thread
+    if (options.accessLogSampleRate <= 0.0) {
+        accessSamplePeriod_ = 0;
+    } else if (options.accessLogSampleRate >= 1.0) {
+        accessSamplePeriod_ = 1;
+    } else {
+        accessSamplePeriod_ = static_cast<std::uint32_t>(std::lround(1.0 / options.accessLogSampleRate));
+    }
 }
 
-void Logger::error(const std::string& message) {
-    spdlog::error(message);
+void Logger::shutdown() {
+    spdlog::shutdown();
+    accessLogger_.reset();
 }
 
-void Logger::warn(const std::string& message) {
-    spdlog::warn(message);
+bool Logger::sampleAccess(unsigned status) {
+    if (!accessLogger_) {
+        return false;
+    }
+    if (status >= 500) {
+        return true;
+    }
+    if (accessSamplePeriod_ == 0) {
+        return false;
+    }
+    thread_local std::uint32_t counter = 0;
+    return counter++ % accessSamplePeriod_ == 0;
 }
 
-void Logger::debug(const std::string& message) {
-    spdlog::debug(message);
+void Logger::access(std::string_view method, std::string_view target, unsigned status,
+                    std::size_t bytes, std::chrono::microseconds duration) {
+    accessLogger_->info("method={} target=\"{}\" status={} bytes={} duration_us={}",
+                        method, target, status, bytes, duration.count());
 }
 
 } // namespace utils
@@ -0,0 +1,234 @@
+#include "utils/Metrics.h"
+#include <charconv>
+#include <stdexcept>
+
+namespace utils {
+
+namespace {
+
+void appendNumber(std::string& out, double value,
+                  std::chars_format format = std::chars_format::general) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, format);
+    out.append(buffer, result.ptr);
+}
+
+void appendNumber(std::string& out, std::uint64_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void appendNumber(std::string& out, std::int64_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// name{labels} or name{labels,extra}, without braces when both are empty
+void appendSeries(std::string& out, std::string_view name, std::string_view suffix,
+                  std::string_view labels, std::string_view extra = {}) {
+    out.append(name);
+    out.append(suffix);
+    if (labels.empty() && extra.empty()) {
+        out.push_back(' ');
+        return;
+    }
+    out.push_back('{');
+    out.append(labels);
+    if (!labels.empty() && !extra.empty()) {
+        out.push_back(',');
+    }
+    out.append(extra);
+    out.append("} ");
+}
+
+void appendHeader(std::string& out, std::string_view name, std::string_view help,
+                  std::string_view type) {
+    out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+    out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+std::size_t stripeIndex(std::size_t stripes) {
+    static std::atomic<std::size_t> next{0};
+    thread_local std::size_t index = next.fetch_add(1, std::memory_order_relaxed);
+    return index % stripes;
+}
+
+} // namespace
+
+void Counter::render(std::string& out, const std::string& name,
+                     const std::string& labels) const {
+    appendSeries(out, name, "", labels);
+    appendNumber(out, value());
+    out.push_back('\n');
+}
+
+void Gauge::render(std::string& out, const std::string& name,
+                   const std::string& labels) const {
+    appendSeries(out, name, "", labels);
+    appendNumber(out, value());
+    out.push_back('\n');
+}
+
+void Histogram::observe(std::chrono::nanoseconds duration) {
+    auto nanos = static_cast<std::uint64_t>(duration.count() > 0 ? duration.count() : 0);
+    auto micros = nanos / 1000;
+
+    std::size_t bucket = 0;
+    while (bucket < kBoundsMicros.size() && micros > kBoundsMicros[bucket]) {
+        ++bucket;
+    }
+
+    auto& stripe = stripes_[stripeIndex(kStripes)];
+    stripe.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    stripe.sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+std::uint64_t Histogram::count() const {
+    std::uint64_t total = 0;
+    for (const auto& stripe : stripes_) {
+        for (const auto& bucket : stripe.buckets) {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+void Histogram::render(std::string& out, const std::string& name,
+                       const std::string& labels) const {
+    std::array<std::uint64_t, kBoundsMicros.size() + 1> counts{};
+    std::uint64_t sumNanos = 0;
+    for (const auto& stripe : stripes_) {
+        for (std::size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += stripe.buckets[i].load(std::memory_order_relaxed);
+        }
+        sumNanos += stripe.sumNanos.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t cumulative = 0;
+    std::string le;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        cumulative += counts[i];
+        le = "le=\"";
+        if (i < kBoundsMicros.size()) {
+            appendNumber(le, static_cast<double>(kBoundsMicros[i]) / 1e6,
+                         std::chars_format::fixed);
+        } else {
+            le += "+Inf";
+        }
+        le += "\"";
+        appendSeries(out, name, "_bucket", labels, le);
+        appendNumber(out, cumulative);
+        out.push_back('\n');
+    }
+
+    appendSeries(out, name, "_sum", labels);
+    appendNumber(out, static_cast<double>(sumNanos) / 1e9);
+    out.push_back('\n');
+    appendSeries(out, name, "_count", labels);
+    appendNumber(out, cumulative);
+    out.push_back('\n');
+}
+
+void MetricsWriter::counter(std::string_view name, std::string_view help, double value,
+                            std::string_view labels) {
+    sample(name, help, "counter", value, labels);
+}
+
+void MetricsWriter::gauge(std::string_view name, std::string_view help, double value,
+                          std::string_view labels) {
+    sample(name, help, "gauge", value, labels);
+}
+
+void MetricsWriter::sample(std::string_view name, std::string_view help, std::string_view type,
+                           double value, std::string_view labels) {
+    // Consecutive samples of one family share a single header
+    if (lastFamily_ != name) {
+        appendHeader(out_, name, help, type);
+        lastFamily_ = std::string(name);
+    }
+    appendSeries(out_, name, "", labels);
+    appendNumber(out_, value);
+    out_.push_back('\n');
+}
+
+MetricsRegistry& MetricsRegistry::global() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+template <typename T>
+T& MetricsRegistry::series(const std::string& name, const std::string& help, const char* type,
+                           const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto& family = families_[name];
+    if (family.type.empty()) {
+        family.help = help;
+        family.type = type;
+    } else if (family.type != type) {
+        throw std::logic_error("Metric " + name + " registered as " + family.type);
+    }
+
+    auto& metric = family.series[labels];
+    if (!metric) {
+        metric = std::make_unique<T>();
+    }
+    return static_cast<T&>(*metric);
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                  const std::string& labels) {
+    return series<Counter>(name, help, "counter", labels);
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                              const std::string& labels) {
+    return series<Gauge>(name, help, "gauge", labels);
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const std::string& labels) {
+    return series<Histogram>(name, help, "histogram", labels);
+}
+
+void MetricsRegistry::addCollector(Collector collector) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    collectors_.push_back(std::move(collector));
+}
+
+std::string MetricsRegistry::render() const {
+    std::string out;
+    out.reserve(16384);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, family] : families_) {
+        appendHeader(out, name, family.help, family.type);
+        for (const auto& [labels, metric] : family.series) {
+            metric->render(out, name, labels);
+        }
+    }
+
+    for (const auto& collector : collectors_) {
+        MetricsWriter writer(out);
+        collector(writer);
+    }
+    return out;
+}
+
+std::string MetricsRegistry::escapeLabel(std::string_view value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '"': escaped += "\\\""; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped.push_back(c);
+        }
+    }
+    return escaped;
+}
+
+} // namespace utils
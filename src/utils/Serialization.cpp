@@ -0,0 +1,124 @@
+#include "utils/Serialization.h"
+#include "utils/AcceptList.h"
+#include "utils/Utf8.h"
+#include <stdexcept>
+
+namespace utils {
+
+namespace {
+
+// Media ranges naming a format the service writes; wildcards stand for JSON
+bool matchMediaRange(std::string_view range, MediaType& type) {
+    if (AcceptList::equalsIgnoreCase(range, "application/json") || range == "*/*" ||
+        AcceptList::equalsIgnoreCase(range, "application/*")) {
+        type = MediaType::Json;
+    } else if (AcceptList::equalsIgnoreCase(range, "application/msgpack") ||
+               AcceptList::equalsIgnoreCase(range, "application/x-msgpack") ||
+               AcceptList::equalsIgnoreCase(range, "application/vnd.msgpack")) {
+        type = MediaType::MessagePack;
+    } else if (AcceptList::equalsIgnoreCase(range, "application/cbor")) {
+        type = MediaType::Cbor;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void requireUtf8(const nlohmann::json& document) {
+    if (document.is_string()) {
+        if (!isValidUtf8(document.get_ref<const std::string&>())) {
+            throw std::invalid_argument("string is not valid UTF-8");
+        }
+    } else if (document.is_object()) {
+        for (const auto& [name, member] : document.items()) {
+            if (!isValidUtf8(name)) {
+                throw std::invalid_argument("key is not valid UTF-8");
+            }
+            requireUtf8(member);
+        }
+    } else if (document.is_array()) {
+        for (const auto& element : document) {
+            requireUtf8(element);
+        }
+    }
+}
+
+} // namespace
+
+std::string_view mediaTypeName(MediaType type) {
+    switch (type) {
+        case MediaType::MessagePack:
+            return "application/msgpack";
+        case MediaType::Cbor:
+            return "application/cbor";
+        case MediaType::Json:
+            break;
+    }
+    return "application/json";
+}
+
+MediaType negotiateMediaType(std::string_view accept) {
+    auto best = MediaType::Json;
+    double bestQuality = 0.0;
+    bool bestNamed = false;
+
+    AcceptList items(accept);
+    std::string_view range;
+    double quality = 0.0;
+    while (items.next(range, quality)) {
+        MediaType type;
+        if (quality <= 0.0 || !matchMediaRange(range, type)) {
+            continue;
+        }
+        bool named = range.find('*') == std::string_view::npos;
+        if (quality > bestQuality || (quality == bestQuality && named && !bestNamed)) {
+            best = type;
+            bestQuality = quality;
+            bestNamed = named;
+        }
+    }
+    return best;
+}
+
+MediaType bodyMediaType(std::string_view contentType) {
+    auto type = MediaType::Json;
+    auto essence = AcceptList::trim(contentType.substr(0, contentType.find(';')));
+    if (essence.find('*') == std::string_view::npos) {
+        matchMediaRange(essence, type);
+    }
+    return type;
+}
+
+nlohmann::json parseBody(MediaType type, std::string_view body) {
+    nlohmann::json document;
+    switch (type) {
+        case MediaType::MessagePack:
+            document = nlohmann::json::from_msgpack(body.begin(), body.end());
+            requireUtf8(document);
+            return document;
+        case MediaType::Cbor:
+            document = nlohmann::json::from_cbor(body.begin(), body.end());
+            requireUtf8(document);
+            return document;
+        case MediaType::Json:
+            break;
+    }
+    return nlohmann::json::parse(body.begin(), body.end());
+}
+
+std::string dumpBody(MediaType type, const nlohmann::json& document) {
+    std::string body;
+    switch (type) {
+        case MediaType::MessagePack:
+            nlohmann::json::to_msgpack(document, nlohmann::detail::output_adapter<char>(body));
+            return body;
+        case MediaType::Cbor:
+            nlohmann::json::to_cbor(document, nlohmann::detail::output_adapter<char>(body));
+            return body;
+        case MediaType::Json:
+            break;
+    }
+    return document.dump();
+}
+
+} // namespace utils
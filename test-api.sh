@@ -47,6 +47,13 @@ echo "5. Getting the created product..."
 curl -s -X GET "$BASE_URL/products/$PRODUCT_ID" | jq '.'
 echo -e "\n"
 
+# Ids are case-insensitive: the upper case form must be found, not listed as missing
+echo "5a. Getting the created product by ids= in upper case..."
+curl -s -X GET "$BASE_URL/products?ids=${PRODUCT_ID^^},$PRODUCT_ID" \
+  | jq -e '(.items | length) == 1 and (.missing | length) == 0'
+curl -s -X GET "$BASE_URL/products/${PRODUCT_ID^^}" | jq -e --arg id "$PRODUCT_ID" '.id == $id'
+echo -e "\n"
+
 # Update the product
 echo "6. Updating the product..."
 UPDATE_DATA='{
@@ -61,6 +68,14 @@ curl -s -X PUT "$BASE_URL/products/$PRODUCT_ID" \
   -d "$UPDATE_DATA" | jq '.'
 echo -e "\n"
 
+# Bulk targets are case-insensitive too
+echo "6a. Bulk updating the product by its upper case id..."
+BULK_DATA='{"operations": [{"op": "update", "id": "'"${PRODUCT_ID^^}"'", "product": {"name": "Bulk Test Product", "description": "Updated in bulk", "price": 24.99, "stock": 50, "category": "Test"}}]}'
+curl -s -X POST "$BASE_URL/products/_bulk" \
+  -H "Content-Type: application/json" \
+  -d "$BULK_DATA" | jq -e --arg id "$PRODUCT_ID" '.results[0].status == 200 and .results[0].id == $id'
+echo -e "\n"
+
 # Delete the product
 echo "7. Deleting the product..."
 curl -s -X DELETE "$BASE_URL/products/$PRODUCT_ID" | jq '.'